@@ -1,9 +1,13 @@
 #include "AI.h"
 
 #include <algorithm>
-// #include <chrono>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <map>
 #include <utility>
 
+#include "../common/Log.h"
 #include "../common/utility.h"
 #include "Backtrack.h"
 
@@ -31,13 +35,35 @@ AI::AI() {
   objectives2 = {batObjective, powerupObjective, positioningObjective};
 }
 
+AI::~AI() {
+  for (Objective* objective : objectives) delete objective;
+  if (endgame_loader.joinable()) endgame_loader.join();
+}
+
+void AI::load_tables(bool endgame_in_background) {
+  auto load_endgame = [this]() {
+    ifstream endgame_table("endgame.tbl");
+    endgame_solver.load(endgame_table);
+  };
+  if (endgame_in_background) {
+    endgame_loader = thread(load_endgame);
+  } else {
+    load_endgame();
+  }
+  ifstream opening_book_file("opening.book");
+  opening_book.load(opening_book_file);
+  ifstream opponent_model_file("opponent.model");
+  opponent_model.load(opponent_model_file);
+  ifstream evaluator_weights("evaluator.weights");
+  evaluator.load(evaluator_weights);
+}
+
 void AI::set_state(GameState&& game_state) {
   state = move(game_state);
-  score_calculator.update(state, initial_data);
   if (protection) --protection;
   if (self.health < prev_health) {
     protection = 3;
-    cerr << "WE LOST A LIFE!!!" << endl;
+    LOG(INFO) << "WE LOST A LIFE!!!";
   }
   prev_health = self.health;
   int opponent_max_health = 0;
@@ -54,19 +80,33 @@ void AI::set_state(GameState&& game_state) {
       self = vampire;
     }
   }
-  grid.init(state, initial_data);
-
-  if (self.pos == prev_pos && grid[self.pos].powerup.has_value() && grid[self.pos].powerup.value().ticks > -1) {
+  optional<Powerup> powerup_here;
+  for (const Powerup& powerup : state.powerups) {
+    if (powerup.pos == self.pos) powerup_here = powerup;
+  }
+  if (self.pos == prev_pos && powerup_here.has_value() && powerup_here.value().ticks > -1) {
     ++protect_steps;
-  } else if (grid[self.pos].powerup.has_value() && grid[self.pos].powerup.value().ticks >= -1) {
+  } else if (powerup_here.has_value() && powerup_here.value().ticks >= -1) {
     protect_steps = 1;
   } else {
     protect_steps = 0;
   }
 
-  grid.step();
-  path_finder.init(grid, self);
-  path_finder.init_step_safety_checker(state);
+  auto forecast_start = chrono::steady_clock::now();
+  auto pondered = ponderer.take(state);
+  if (pondered.has_value()) {
+    grid = move(pondered->grid);
+    path_finder = move(pondered->path_finder);
+  } else {
+    build_forecast(state, initial_data, self, grid, path_finder);
+  }
+  chrono::duration<double> forecast_seconds = chrono::steady_clock::now() - forecast_start;
+  LOG(INFO) << "Forecast took: " << forecast_seconds.count() << " seconds"
+            << (pondered.has_value() ? " (pondered)" : "");
+  // Both forecasts start with the step from state
+  score_calculator.update(grid, state);
+  opponent_model.observe(grid, self.id);
+  reachability_map.reset();
 
   // std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
@@ -77,14 +117,6 @@ void AI::set_state(GameState&& game_state) {
   //   std::cerr << "Backtrack findUnsafeMoves time = "
   //             << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
 
-  opponent_path_finders.clear();
-  for (const Vampire& vampire : state.vampires) {
-    if (vampire.id != self.id) {
-      opponent_path_finders[vampire.id].init(grid, vampire);
-      // TODO decide if we want to use safety checker for the opponents
-    }
-  }
-
   for (auto it = throwable_grenades.begin(); it != throwable_grenades.end();) {
     const auto& grenades = grid[*it].grenades;
     if (find_if(grenades.begin(), grenades.end(),
@@ -97,8 +129,28 @@ void AI::set_state(GameState&& game_state) {
   prev_pos = self.pos;
 }
 
-Step AI::get_step() {
-  auto result = evaluate_objectives(false);
+Step AI::get_step(const Deadline& deadline) {
+  // The fallback is searched first, with its own share of the time, so the objectives can't leave it without any
+  path_finder.deadline = deadline.part(0.25);
+  escape_step = path_finder.find_escape_step();
+  path_finder.deadline = deadline;
+  auto endgame_step = solve_endgame(deadline);
+  if (endgame_step.has_value()) {
+    plan.reset();
+    return endgame_step.value();
+  }
+  // Only plain moves are taken from the book, grenade steps go through the full evaluation so that the objective
+  // placing the grenade owns it
+  auto book_step = opening_book.lookup(state, initial_data.size);
+  if (book_step.has_value() && !book_step->place_grenade && !book_step->throw_grenades.has_value() &&
+      book_step->move.has_value()) {
+    LOG(INFO) << "Winning objective: OpeningBook";
+    plan.reset();
+    return book_step.value();
+  }
+  auto followed = follow_plan();
+  auto result = followed.has_value() ? followed.value() : evaluate_objectives(false, deadline);
+  if (!followed.has_value()) keep_plan(result.first, result.second, 0);
   Objective::EvalResult best = result.first;
   if (best.step.place_grenade) {
     grenade_owner_objective[self.pos] = result.second;
@@ -111,9 +163,10 @@ Step AI::get_step() {
       grid[self.pos].grenades.push_back(state.grenades.back());
       path_finder.init(grid, self, true);
       path_finder.init_step_safety_checker(state);
-      cerr << "Objective finished, starting a new one" << endl;
-      Objective::EvalResult next_best = evaluate_objectives(true).first;
-      best.step.move = next_best.step.move;
+      reachability_map.reset();
+      LOG(DEBUG) << "Objective finished, starting a new one";
+      Objective::EvalResult next_best = evaluate_objectives(true, deadline).first;
+      best.step.move = next_best.step.move.has_value() ? next_best.step.move : path_finder.find_escape_step().move;
     }
   } else if (best.step.throw_grenades.has_value()) {
     if (!best.step.move.has_value()) {
@@ -121,20 +174,46 @@ Step AI::get_step() {
       state.grenades = grid.get_state().grenades;
       path_finder.init(grid, self);
       path_finder.init_step_safety_checker(state);
-      cerr << "Objective finished, starting a new one" << endl;
-      Objective::EvalResult next_best = evaluate_objectives(true).first;
-      best.step.move = next_best.step.move;
+      reachability_map.reset();
+      LOG(DEBUG) << "Objective finished, starting a new one";
+      Objective::EvalResult next_best = evaluate_objectives(true, deadline).first;
+      best.step.move = next_best.step.move.has_value() ? next_best.step.move : path_finder.find_escape_step().move;
     }
   } else {
     if (!best.step.move.has_value()) {
-      cerr << "Can't do anything meaningful" << endl;
+      LOG(INFO) << "Can't do anything meaningful, escaping";
+      best.step = escape_step;
     } else if (best.step.move.value().empty()) {
-      cerr << "Waiting" << endl;
+      LOG(DEBUG) << "Waiting";
     }
   }
   return best.step;
 }
 
+void AI::ponder(const GameState& received_state, const Step& step) {
+  // The enemies the opponent model knows are expected to make their most likely move, the others to stay
+  map<int, Step> steps{{self.id, step}};
+  for (const Vampire& enemy : grid.get_enemies(self.id)) {
+    if (!opponent_model.knows(grid, enemy, self.pos)) continue;
+    map<Pos, vector<Direction>> move_to;
+    for (const auto& move : moves_3) {
+      if (move.size() > 2 && !grid.shoes_before_step.at(enemy.id)) continue;
+      Pos pos = enemy.pos;
+      bool valid = true;
+      for (size_t i = 0; valid && i < move.size(); ++i) {
+        pos += pos_deltas[(int)move[i]];
+        valid = grid.field_at(pos).can_step_here();
+      }
+      if (valid) move_to.emplace(pos, move);
+    }
+    vector<Pos> destinations;
+    for (const auto& destination_move : move_to) destinations.push_back(destination_move.first);
+    auto likely = opponent_model.predict(grid, enemy, self.pos, destinations, 1);
+    if (!likely.empty()) steps[enemy.id] = Step{false, nullopt, move_to[likely[0].first]};
+  }
+  ponderer.start(received_state, initial_data, grid, steps);
+}
+
 vector<Pos> AI::grenade_positions_for(Pos target) const { return positions_for(target, self.range, true); }
 
 vector<Pos> AI::setup_positions_for(Pos target) const {
@@ -189,6 +268,14 @@ vector<AI::ThrowOption> AI::throw_options_from(Pos pos) const {
   return result;
 }
 
+const ReachabilityMap& AI::reachability() {
+  if (!reachability_map.has_value()) {
+    reachability_map.emplace();
+    reachability_map->init(path_finder.timeline, state.vampires);
+  }
+  return *reachability_map;
+}
+
 int AI::ticks_to_wait_until_grenade() {
   if (self.grenades > 0) return 0;
   int min_tick = 5;
@@ -200,22 +287,95 @@ int AI::ticks_to_wait_until_grenade() {
   return min_tick;
 }
 
-std::pair<Objective::EvalResult, Objective*> AI::evaluate_objectives(bool secondary) {
+// Gets at most half of the time, the objectives decide if it can't solve the position in time
+optional<Step> AI::solve_endgame(const Deadline& deadline) {
+  if (state.vampires.size() != 2 || state.tick <= initial_data.max_tick) return nullopt;
+  if (endgame_loader.joinable()) endgame_loader.join();
+  GameState endgame_state = state;
+  endgame_state.powerups.clear();  // not part of the solver's model
+  Grid endgame_grid(endgame_state, initial_data);
+  if (!EndgameSolver::applies(endgame_grid)) return nullopt;
+  auto result = endgame_solver.solve(endgame_grid, self.id, deadline.part(0.5));
+  if (!result.has_value()) {
+    LOG(INFO) << "Endgame is not solved in time";
+    return nullopt;
+  }
+  LOG(INFO) << "Winning objective: EndgameSolver: health difference " << result->value;
+  return result->step;
+}
+
+// Plans are only followed in quiet phases: the next step is a plain move, no opponent is close enough to be attacked
+// and a full evaluation was done recently. Grenade steps always go through the full evaluation.
+optional<pair<Objective::EvalResult, Objective*>> AI::follow_plan() {
+  if (!plan.has_value()) return nullopt;
+  Plan current = move(plan.value());
+  plan.reset();
+  auto& path = current.result.path;
+  path.erase(path.begin());
+  if (current.tick + 1 != state.tick || current.next_pos != self.pos || current.age + 1 >= plan_refresh_ticks ||
+      path.empty() || path[0].place_grenade || path[0].throw_grenades.has_value() || !path[0].move.has_value()) {
+    return nullopt;
+  }
+  for (const Vampire& vampire : state.vampires) {
+    if (vampire.id != self.id && manhattan_distance(vampire.pos, self.pos) <= quiet_distance) return nullopt;
+  }
+  if (!path_finder.is_path_valid(path) || !current.objective->is_plan_valid(*this, current.result)) return nullopt;
+  current.result.step = path[0];
+  LOG(INFO) << "Following the plan: " << [&](ostream& os) { os << current.result.describe(); };
+  keep_plan(current.result, current.objective, current.age + 1);
+  return make_pair(current.result, current.objective);
+}
+
+void AI::keep_plan(const Objective::EvalResult& result, Objective* objective, int age) {
+  if (!objective || result.path.size() < 2) return;
+  const Step& step = result.path[0];
+  if (step.place_grenade || step.throw_grenades.has_value() || !step.move.has_value()) return;
+  Pos next_pos = self.pos;
+  for (Direction dir : step.move.value()) next_pos += pos_deltas[(int)dir];
+  plan = Plan{objective, result, next_pos, state.tick, age};
+}
+
+std::pair<Objective::EvalResult, Objective*> AI::evaluate_objectives(bool secondary, const Deadline& deadline) {
   Objective::EvalResult best;
   Objective* bestobj = nullptr;
+  // Only the results with a positive score compete, the position value can be negative
+  double best_rank = -numeric_limits<double>::infinity();
   const auto& objectives_used = secondary ? objectives2 : objectives;
   for (Objective* objective : objectives_used) {
-    Objective::EvalResult result = objective->evaluate(*this, secondary);
-    if (result.score > best.score) {
+    if (deadline.expired()) {
+      LOG(INFO) << "Out of time, skipping the remaining objectives";
+      break;
+    }
+    Objective::EvalResult result = objective->evaluate(*this, secondary, deadline);
+    if (result.score <= 0) continue;
+    double rank = result.score + evaluator_weight * position_value(result.step);
+    if (rank > best_rank) {
       best = result;
       bestobj = objective;
+      best_rank = rank;
     }
   }
-  cerr << endl << "Winning objective: " << best.description << endl;
-  cerr << "Score: " << best.score << endl;
+  LOG(INFO) << "Winning objective: " << [&](ostream& os) { os << best.describe(); };
+  LOG(INFO) << "Score: " << best.score;
   return {best, bestobj};
 }
 
+// What the evaluator expects us to collect after the step, 0 without its weights
+double AI::position_value(const Step& step) {
+  if (!evaluator.is_loaded()) return 0;
+  // Where the step ends, a move stops before the first field it can't enter, like in Grid::step_vampires
+  Pos pos = self.pos;
+  if (step.move.has_value()) {
+    const vector<Direction>& move = step.move.value();
+    for (size_t i = 0; i < move.size(); ++i) {
+      Pos next = pos + pos_deltas[(int)move[i]];
+      if (!grid.field_at(next).can_step_here() || (i == 2 && !grid.shoes_before_step.at(self.id))) break;
+      pos = next;
+    }
+  }
+  return evaluator.evaluate(*this, pos);
+}
+
 std::vector<Pos> AI::positions_for(Pos target, int range, bool break_on_obstacle) const {
   vector<Pos> positions;
   for (const Pos& delta : pos_deltas) {
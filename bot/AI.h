@@ -1,16 +1,34 @@
 #ifndef GAMEMAP_H_INCLUDED
 #define GAMEMAP_H_INCLUDED
 
+#include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "../common/GameState.h"
 #include "../common/ScoreCalculator.h"
+#include "Deadline.h"
+#include "EndgameSolver.h"
+#include "Evaluator.h"
 #include "Objective.h"
+#include "OpeningBook.h"
+#include "OpponentModel.h"
 #include "PathFinder.h"
+#include "Ponderer.h"
+#include "ReachabilityMap.h"
 
 class AI {
  public:
+  // The path of the winning objective, followed over the next ticks while it stays valid
+  struct Plan {
+    Objective* objective;
+    Objective::EvalResult result;  // result.path starts with the step we have just sent
+    Pos next_pos;                  // where we are after that step
+    int tick;
+    int age;
+  };
+
   struct ThrowOption {
     Pos target_pos;
     Throw throw_step;
@@ -26,27 +44,51 @@ class AI {
   PathFinder path_finder;
   ScoreCalculator score_calculator;
   Vampire self;
-  std::vector<Objective*> objectives;
-  std::vector<Objective*> objectives2;
+  std::vector<Objective*> objectives;   // in priority order, the ones at the end are skipped when time runs out, owned
+  std::vector<Objective*> objectives2;  // some of objectives
   int protection = 0;
   bool offensive_mode;
-  std::unordered_map<int, PathFinder> opponent_path_finders;
   std::unordered_set<Pos, Pos::hash> throwable_grenades;
   std::unordered_map<Pos, Objective*, Pos::hash> grenade_owner_objective;
   int protect_steps;
   Pos prev_pos;
+  Step escape_step;  // safe move we fall back to if no objective has found anything in time
+  std::optional<Plan> plan;
+  EndgameSolver endgame_solver;
+  OpeningBook opening_book;
+  OpponentModel opponent_model;
+  Evaluator evaluator;
 
   AI();
+  ~AI();
+  // Loads endgame.tbl, opening.book, opponent.model and evaluator.weights from the working directory, the ones missing
+  // are not used. The endgame table is only needed after max_tick, in the background it is waited for then.
+  void load_tables(bool endgame_in_background = false);
   void set_state(GameState&& game_state);
-  Step get_step();
+  Step get_step(const Deadline& deadline = {});
+  // Starts preparing the next tick, received_state is the one we have just answered with step
+  void ponder(const GameState& received_state, const Step& step);
   std::vector<Pos> grenade_positions_for(Pos target) const;
   std::vector<Pos> setup_positions_for(Pos target) const;
   std::vector<ThrowOption> throw_options_from(Pos pos) const;
+  // Computed on first use, on the forecast of path_finder
+  const ReachabilityMap& reachability();
   int ticks_to_wait_until_grenade();  // this is naive now, does not consider chain reactions
  private:
+  static const int plan_refresh_ticks = 4;          // a full evaluation is done at least this often
+  static const int quiet_distance = 6;              // plans are not followed with an opponent this close
+  static constexpr double evaluator_weight = 0.25;  // of the learned value of the position after the step
+
   int prev_health = -1;
-  std::pair<Objective::EvalResult, Objective*> evaluate_objectives(bool second);
+  Ponderer ponderer;
+  std::thread endgame_loader;
+  std::optional<ReachabilityMap> reachability_map;
+  std::pair<Objective::EvalResult, Objective*> evaluate_objectives(bool second, const Deadline& deadline);
+  std::optional<std::pair<Objective::EvalResult, Objective*>> follow_plan();
+  std::optional<Step> solve_endgame(const Deadline& deadline);
+  void keep_plan(const Objective::EvalResult& result, Objective* objective, int age);
   std::vector<Pos> positions_for(Pos target, int range, bool break_on_obstacle) const;
+  double position_value(const Step& step);
 };
 
 #endif  // GAMEMAP_H_INCLUDED
@@ -0,0 +1,61 @@
+#include "Arena.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+
+#include "../common/Grid.h"
+#include "../common/ScoreCalculator.h"
+#include "../common/utility.h"
+#include "Deadline.h"
+
+using namespace std;
+
+Arena::Arena(const string& map_file) {
+  ifstream f(map_file);
+  if (!f) error("Can't open map " + map_file);
+  auto read_message = [&f]() {
+    vector<string> lines;
+    string line;
+    while (getline(f, line) && line != ".") lines.push_back(line);
+    return lines;
+  };
+  init_data = InitialData(read_message());
+  map_state = GameState(read_message());
+  tables.load_tables();
+}
+
+vector<double> Arena::play(int seed, chrono::milliseconds think_time) const {
+  Grid grid(seed, true /* server */);
+  grid.init(map_state, init_data);
+  map<int, unique_ptr<AI>> ais;
+  for (const Vampire& vampire : map_state.vampires) {
+    auto& ai = ais[vampire.id] = make_unique<AI>();
+    ai->initial_data = init_data;
+    ai->endgame_solver = tables.endgame_solver;
+    ai->opening_book = tables.opening_book;
+    ai->opponent_model = tables.opponent_model;
+    ai->evaluator = tables.evaluator;
+  }
+
+  // The loop of Simulation::run
+  int num_vampires = grid.get_state().vampires.size();
+  while (num_vampires > 0) {
+    GameState game_state = grid.get_state();
+    num_vampires = game_state.vampires.size();
+    map<int, Step> vampire_steps;
+    for (const Vampire& vampire : game_state.vampires) {
+      auto ai = ais.find(vampire.id);
+      if (ai == ais.end()) continue;
+      Deadline deadline = think_time.count() ? Deadline::after(think_time) : Deadline{};
+      ai->second->set_state(game_state.request_for(init_data.game_id, vampire.id));
+      vampire_steps[vampire.id] = ai->second->get_step(deadline);
+    }
+    grid.step(vampire_steps);
+  }
+
+  ScoreCalculator score_calculator;
+  score_calculator.init_from_grid(grid);
+  return {score_calculator.total_score.begin() + min<size_t>(1, score_calculator.total_score.size()),
+          score_calculator.total_score.end()};
+}
@@ -0,0 +1,28 @@
+#ifndef ITECH21_ARENA_H
+#define ITECH21_ARENA_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "AI.h"
+
+// Plays games in process like the server does: every vampire of the map is played by an AI, the states are passed to
+// them without the protocol, and the Grid steps with the rules of the server. The AIs don't ponder.
+class Arena {
+ public:
+  InitialData init_data;
+  GameState map_state;
+
+  // Reads the map and loads the tables of the AIs from the working directory, see AI::load_tables
+  explicit Arena(const std::string& map_file);
+  // Returns the scores of vampire 1, 2, ... like scores.json of the server. The AIs think without a time limit if
+  // think_time is 0, the bot gets 150ms in the console.
+  std::vector<double> play(int seed, std::chrono::milliseconds think_time = {}) const;
+
+ private:
+  AI tables;
+};
+
+#endif  // ITECH21_ARENA_H
@@ -66,7 +66,8 @@ vector<int> get_possible_moves(const Grid &grid, vector<vector<bool>> &is_move_u
 // The return value is a bitmap of unsafe flags for moves_3 entries with placing grenade and without
 // eg.: value[1][move_idx] == true  =>  moves_3[move_idx] with placing grenade is a bad choice
 std::pair<bool, vector<vector<bool>>> Backtrack::findUnsafeMoves(const AI &ai, const Grid &grid, int simulate_steps,
-                                                                 bool return_on_first_safe, int only_enemy_id) {
+                                                                 bool return_on_first_safe, int only_enemy_id,
+                                                                 const Deadline &deadline) {
   vector<vector<bool>> is_move_unsafe(2, vector<bool>(moves_3.size(), false));
 
   auto self = grid.get_vampire(ai.self.id);
@@ -98,6 +99,7 @@ std::pair<bool, vector<vector<bool>>> Backtrack::findUnsafeMoves(const AI &ai, c
     for (int self_place_grenade = 0; self_place_grenade < (simulate_steps == 1 ? 1 : 2) &&
                                      self_place_grenade <= grid.grenades_before_step.at(self.value().id);
          self_place_grenade++) {
+      if (deadline.expired()) goto unsafe;
       // for each enemy with move + grenade placement
       for (const auto &enemy : enemies) {
         // move is already unsafe because of other vampire can kill us
@@ -117,11 +119,13 @@ std::pair<bool, vector<vector<bool>>> Backtrack::findUnsafeMoves(const AI &ai, c
             if (!next_self.has_value()) goto unsafe;
 
             PathFinder pf;
+            pf.deadline = deadline;
             pf.init(next_grid, next_self.value());
             bool is_survivable = pf.is_survivable();
             // next_grid.print(cerr);
-            if (!is_survivable || (simulate_steps > 1 &&
-                                   !findUnsafeMoves(ai, next_grid, simulate_steps - 1, true, enemy.first.id).first)) {
+            if (!is_survivable ||
+                (simulate_steps > 1 &&
+                 !findUnsafeMoves(ai, next_grid, simulate_steps - 1, true, enemy.first.id, deadline).first)) {
               goto unsafe;
               is_move_unsafe[self_place_grenade][self_move_idx] = true;
             }
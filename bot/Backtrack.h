@@ -3,13 +3,16 @@
 
 #include "../common/GameState.h"
 #include "../common/Grid.h"
+#include "Deadline.h"
 
 class AI;
 
 class Backtrack {
  public:
+  // Moves that could not be checked before the deadline are reported as unsafe
   std::pair<bool, std::vector<std::vector<bool>>> findUnsafeMoves(const AI &ai, const Grid &grid, int simulateSteps,
-                                                                  bool returnOnFirstSafe, int enemy_id);
+                                                                  bool returnOnFirstSafe, int enemy_id,
+                                                                  const Deadline &deadline = {});
 };
 
 #endif  // ITECH21_BACKTRACK_H
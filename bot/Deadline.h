@@ -0,0 +1,31 @@
+#ifndef ITECH21_DEADLINE_H
+#define ITECH21_DEADLINE_H
+
+#include <chrono>
+
+// Cooperative time limit of a computation. Long running searches poll expired() and return the best result they have
+// found so far. A default constructed Deadline never expires.
+class Deadline {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  Deadline() : at{clock::time_point::max()} {}
+  explicit Deadline(clock::time_point at) : at{at} {}
+
+  static Deadline after(clock::duration budget) { return Deadline{clock::now() + budget}; }
+
+  bool expired() const { return at != clock::time_point::max() && clock::now() >= at; }
+  clock::duration remaining() const {
+    return at == clock::time_point::max() ? clock::duration::max() : at - clock::now();
+  }
+  // Expires when ratio of the remaining time has passed
+  Deadline part(double ratio) const {
+    if (at == clock::time_point::max()) return *this;
+    return after(std::chrono::duration_cast<clock::duration>(remaining() * ratio));
+  }
+
+ private:
+  clock::time_point at;
+};
+
+#endif  // ITECH21_DEADLINE_H
@@ -0,0 +1,154 @@
+#include "EndgameSolver.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "../common/Symmetry.h"
+
+using namespace std;
+
+const int EndgameSolver::max_free_fields;
+
+bool EndgameSolver::applies(const Grid& grid) {
+  return grid.get_state().vampires.size() == 2 && grid.tick > grid.max_tick && free_fields(grid) <= max_free_fields;
+}
+
+int EndgameSolver::free_fields(const Grid& grid) {
+  int size = grid.fields.size();
+  vector<vector<bool>> lit(size, vector<bool>(size));
+  for (int nTh = 0; nTh < grid.tick - grid.max_tick; nTh++) {
+    Grid::for_ring_fields(size, nTh, [&lit](const Pos& pos) { lit[pos.y][pos.x] = true; });
+  }
+  int count = 0;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      count += !grid.fields[y][x].is_bush && !lit[y][x];
+    }
+  }
+  return count;
+}
+
+// The most fields next to each other in a row or column without a bush between them
+int EndgameSolver::longest_line(const Grid& grid) {
+  int size = grid.fields.size(), longest = 0;
+  for (int i = 0; i < size; ++i) {
+    int row = 0, column = 0;
+    for (int j = 0; j < size; ++j) {
+      row = grid.fields[i][j].is_bush ? 0 : row + 1;
+      column = grid.fields[j][i].is_bush ? 0 : column + 1;
+      longest = max({longest, row, column});
+    }
+  }
+  return longest;
+}
+
+optional<EndgameSolver::Result> EndgameSolver::solve(const Grid& grid, int self_id, const Deadline& deadline) {
+  this->self_id = self_id;
+  opponent_id = -1;
+  for (const Vampire& vampire : grid.get_state().vampires) {
+    if (vampire.id != self_id) opponent_id = vampire.id;
+  }
+  if (opponent_id == -1 || !grid.get_vampire(self_id).has_value()) return nullopt;
+  this->deadline = deadline;
+  aborted = false;
+
+  optional<Result> result;
+  for (const Step& self_step : steps_of(grid, self_id)) {
+    int value = value_of(grid, self_step, result.has_value() ? result->value : INT_MIN);
+    if (aborted) return nullopt;
+    if (!result.has_value() || value > result->value) result = Result{self_step, value};
+  }
+  if (result.has_value()) memo[key_of(grid)] = result->value;
+  return result;
+}
+
+int EndgameSolver::search(const Grid& grid) {
+  string key = key_of(grid);
+  auto it = memo.find(key);
+  if (it != memo.end()) return it->second;
+
+  auto self = grid.get_vampire(self_id);
+  auto opponent = grid.get_vampire(opponent_id);
+  if (!self.has_value() || !opponent.has_value() || (free_fields(grid) == 0 && grid.get_state().grenades.empty())) {
+    return memo[key] = (self.has_value() ? self->health : 0) - (opponent.has_value() ? opponent->health : 0);
+  }
+  if (deadline.expired()) {
+    aborted = true;
+    return 0;
+  }
+  int best = INT_MIN;
+  for (const Step& self_step : steps_of(grid, self_id)) {
+    best = max(best, value_of(grid, self_step, best));
+    if (aborted) return 0;
+  }
+  return memo[key] = best;
+}
+
+// The opponent's best answer to self_step, or anything not greater than cutoff if it is not better than that
+int EndgameSolver::value_of(const Grid& grid, const Step& self_step, int cutoff) {
+  int worst = INT_MAX;
+  for (const Step& opponent_step : steps_of(grid, opponent_id)) {
+    Grid next{grid};
+    next.step({{self_id, self_step}, {opponent_id, opponent_step}});
+    worst = min(worst, search(next));
+    if (worst <= cutoff || aborted) break;
+  }
+  return worst;
+}
+
+vector<Step> EndgameSolver::steps_of(const Grid& grid, int vampire_id) const {
+  vector<Step> steps;
+  auto vampire = grid.get_vampire(vampire_id);
+  for (int place_grenade = 0; place_grenade <= (vampire->grenades > 0); ++place_grenade) {
+    for (const auto& move : moves_3) {
+      if (!vampire->shoes && move.size() > 2) break;
+      Pos pos = vampire->pos;
+      bool valid = true;
+      for (Direction dir : move) {
+        pos += pos_deltas[(int)dir];
+        if (!grid[pos].can_step_here()) {
+          valid = false;
+          break;
+        }
+      }
+      if (valid) steps.push_back({(bool)place_grenade, nullopt, move});
+    }
+  }
+  return steps;
+}
+
+// The symmetric images of a position have the same value, so they share the entry. So do the positions that only
+// differ in stats above what can make a difference: a blast stops at the bushes, and a vampire with
+// GRENADE_TICKS + 1 grenades can place one on every tick, the count is checked before the oldest one returns.
+string EndgameSolver::key_of(const Grid& grid) const {
+  GameState state = grid.get_state();
+  state.tick -= grid.max_tick;  // the stage of the ring
+  int max_range = longest_line(grid) - 1;
+  for (Vampire& vampire : state.vampires) {
+    vampire.range = min(vampire.range, max_range);
+    vampire.grenades = min(vampire.grenades, GRENADE_TICKS + 1);
+  }
+  for (Grenade& grenade : state.grenades) grenade.range = min(grenade.range, max_range);
+  string key = canonical_key(state, grid.fields.size(), self_id).key;
+  key.push_back((char)grid.fields.size());
+  return key;
+}
+
+void EndgameSolver::save(ostream& out) const {
+  static const char* digits = "0123456789abcdef";
+  for (const auto& [key, value] : memo) {
+    for (char c : key) out << digits[(unsigned char)c >> 4] << digits[c & 15];
+    out << ' ' << value << '\n';
+  }
+}
+
+void EndgameSolver::load(istream& in) {
+  auto digit = [](char c) { return c <= '9' ? c - '0' : c - 'a' + 10; };
+  string hex;
+  int value;
+  while (in >> hex >> value) {
+    string key(hex.size() / 2, '\0');
+    for (size_t i = 0; i < key.size(); ++i) key[i] = (char)(digit(hex[2 * i]) << 4 | digit(hex[2 * i + 1]));
+    memo[move(key)] = value;
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef ITECH21_ENDGAMESOLVER_H
+#define ITECH21_ENDGAMESOLVER_H
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "Deadline.h"
+
+// Exhaustive search of a 1v1 game once the closing ring has left only a few fields.
+// Both vampires choose simultaneously from every move, optionally placing a grenade before it (throws are not
+// considered). We assume the opponent knows our choice, so the value is guaranteed against any opponent.
+// The value of a state is our health minus the opponent's when one of us dies or the ring has covered every field.
+// Values are memoized on the canonical key of the position, so the positions solved from the other side, their
+// symmetric images and the ones solved offline (see endgame_tables.cpp) are reused. Ranges and grenade counts that
+// play the same share the key.
+class EndgameSolver {
+ public:
+  static const int max_free_fields = 10;
+
+  struct Result {
+    Step step;
+    int value;
+  };
+
+  // Two vampires left and the ring has closed in enough
+  static bool applies(const Grid& grid);
+  // Returns nullopt if the search couldn't finish before the deadline, the states solved so far are kept
+  std::optional<Result> solve(const Grid& grid, int self_id, const Deadline& deadline = {});
+
+  void save(std::ostream& out) const;
+  void load(std::istream& in);
+  size_t size() const { return memo.size(); }
+
+ private:
+  std::unordered_map<std::string, int> memo;
+  int self_id, opponent_id;
+  Deadline deadline;
+  bool aborted;
+
+  static int free_fields(const Grid& grid);
+  static int longest_line(const Grid& grid);
+  std::string key_of(const Grid& grid) const;
+  std::vector<Step> steps_of(const Grid& grid, int vampire_id) const;
+  int search(const Grid& grid);
+  int value_of(const Grid& grid, const Step& self_step, int cutoff);
+};
+
+#endif  // ITECH21_ENDGAMESOLVER_H
@@ -0,0 +1,177 @@
+#include "Evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "AI.h"
+
+using namespace std;
+
+static_assert(Evaluator::hidden % 8 == 0, "the hidden layer is processed in 8 float vectors");
+
+Evaluator::Features Evaluator::features(AI& ai, Pos pos) {
+  Features x{};
+  const Grid& grid = ai.grid;
+  const Timeline& timeline = ai.path_finder.timeline;
+  int size = grid.fields.size();
+  auto inside = [size](Pos p) { return p.y >= 0 && p.x >= 0 && p.y < size && p.x < size; };
+  x[0] = 1;
+
+  // How soon the light gets here
+  int lit = Timeline::NEVER;
+  for (int tick = 0; tick < timeline.length() && lit == Timeline::NEVER; ++tick) {
+    if (timeline.has_light(tick, pos)) lit = tick;
+  }
+  x[1] = lit == Timeline::NEVER ? 0 : 1.0f / (1 + lit);
+
+  // Who gets here first
+  const ReachabilityMap& reachability = ai.reachability();
+  int arrival = min(reachability.arrival(ai.self.id, pos), 20);
+  int rival_arrival = min(reachability.rival_arrival(ai.self.id, pos), 20);
+  x[2] = arrival / 20.0f;
+  x[3] = (rival_arrival - arrival) / 20.0f;
+
+  // The bats our grenade would hit from here
+  int bats = 0, density = 0;
+  for (Pos delta : pos_deltas) {
+    Pos p = pos;
+    for (int i = 1; i <= ai.self.range; ++i) {
+      p += delta;
+      if (!inside(p) || grid[p].is_bush) break;
+      if (grid[p].bat.has_value()) {
+        ++bats;
+        density += grid[p].bat->density;
+        break;
+      }
+    }
+  }
+  x[4] = bats / 4.0f;
+  x[5] = density / 12.0f;
+
+  int nearest = 2 * size, close = 0;
+  for (const Vampire& enemy : grid.get_enemies(ai.self.id)) {
+    int distance = manhattan_distance(enemy.pos, pos);
+    nearest = min(nearest, distance);
+    if (distance <= 3) ++close;
+  }
+  x[6] = nearest / (2.0f * size);
+  x[7] = close / 3.0f;
+
+  x[8] = grid[pos].powerup.has_value();
+  x[9] = ai.self.health / 3.0f;
+  x[10] = min(ai.self.grenades, 3) / 3.0f;
+  x[11] = min(ai.self.range, 5) / 5.0f;
+  x[12] = (float)grid.tick / max(grid.max_tick, 1);
+
+  int free = 0;
+  for (Pos delta : pos_deltas) {
+    Pos p = pos;
+    p += delta;
+    if (inside(p) && grid[p].can_step_here()) ++free;
+  }
+  x[13] = free / 4.0f;
+  x[14] = (float)manhattan_distance(pos, Pos{size / 2, size / 2}) / size;
+  x[15] = !grid[pos].grenades.empty();
+  return x;
+}
+
+void Evaluator::hidden_layer(const Features& x, array<float, hidden>& h) const {
+#ifdef __AVX2__
+  __m256 sums[hidden / 8];
+  for (int j = 0; j < hidden / 8; ++j) sums[j] = _mm256_loadu_ps(&b1[8 * j]);
+  for (int i = 0; i < inputs; ++i) {
+    __m256 xi = _mm256_set1_ps(x[i]);
+    for (int j = 0; j < hidden / 8; ++j) sums[j] = _mm256_fmadd_ps(xi, _mm256_loadu_ps(&w1[i][8 * j]), sums[j]);
+  }
+  for (int j = 0; j < hidden / 8; ++j) _mm256_storeu_ps(&h[8 * j], _mm256_max_ps(sums[j], _mm256_setzero_ps()));
+#else
+  h = b1;
+  for (int i = 0; i < inputs; ++i) {
+    for (int j = 0; j < hidden; ++j) h[j] += x[i] * w1[i][j];
+  }
+  for (float& value : h) value = max(value, 0.0f);
+#endif
+}
+
+float Evaluator::evaluate(const Features& x) const {
+  alignas(32) array<float, hidden> h;
+  hidden_layer(x, h);
+#ifdef __AVX2__
+  __m256 sum = _mm256_setzero_ps();
+  for (int j = 0; j < hidden / 8; ++j)
+    sum = _mm256_fmadd_ps(_mm256_loadu_ps(&h[8 * j]), _mm256_loadu_ps(&w2[8 * j]), sum);
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  return b2 + _mm_cvtss_f32(half);
+#else
+  float y = b2;
+  for (int j = 0; j < hidden; ++j) y += h[j] * w2[j];
+  return y;
+#endif
+}
+
+void Evaluator::train(const vector<pair<Features, float>>& samples, int epochs, float learning_rate) {
+  vector<size_t> order(samples.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  mt19937 random(0);
+  for (int epoch = 0; epoch < epochs; ++epoch) {
+    shuffle(order.begin(), order.end(), random);
+    for (size_t i : order) {
+      const auto& [x, target] = samples[i];
+      array<float, hidden> h;
+      hidden_layer(x, h);
+      float y = b2;
+      for (int j = 0; j < hidden; ++j) y += h[j] * w2[j];
+      float error = y - target;
+      for (int j = 0; j < hidden; ++j) {
+        if (h[j] <= 0) continue;  // the ReLU was off, no gradient
+        float delta = error * w2[j];
+        for (int k = 0; k < inputs; ++k) w1[k][j] -= learning_rate * delta * x[k];
+        b1[j] -= learning_rate * delta;
+      }
+      for (int j = 0; j < hidden; ++j) w2[j] -= learning_rate * error * h[j];
+      b2 -= learning_rate * error;
+    }
+  }
+  loaded = true;
+}
+
+void Evaluator::randomize(unsigned seed) {
+  mt19937 random(seed);
+  normal_distribution<float> distribution(0, sqrt(2.0f / inputs));
+  for (auto& row : w1) {
+    for (float& w : row) w = distribution(random);
+  }
+  b1.fill(0.1f);
+  for (float& w : w2) w = distribution(random);
+  b2 = 0;
+}
+
+void Evaluator::save(ostream& out) const {
+  out << inputs << ' ' << hidden << '\n';
+  for (const auto& row : w1) {
+    for (int j = 0; j < hidden; ++j) out << row[j] << (j + 1 < hidden ? ' ' : '\n');
+  }
+  for (int j = 0; j < hidden; ++j) out << b1[j] << (j + 1 < hidden ? ' ' : '\n');
+  for (int j = 0; j < hidden; ++j) out << w2[j] << (j + 1 < hidden ? ' ' : '\n');
+  out << b2 << '\n';
+}
+
+void Evaluator::load(istream& in) {
+  int file_inputs = 0, file_hidden = 0;
+  loaded = false;
+  if (!(in >> file_inputs >> file_hidden) || file_inputs != inputs || file_hidden != hidden) return;
+  for (auto& row : w1) {
+    for (float& w : row) in >> w;
+  }
+  for (float& b : b1) in >> b;
+  for (float& w : w2) in >> w;
+  in >> b2;
+  loaded = (bool)in;
+}
@@ -0,0 +1,44 @@
+#ifndef ITECH21_EVALUATOR_H
+#define ITECH21_EVALUATOR_H
+
+#include <array>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "../common/positions.h"
+
+class AI;
+
+// A small dense network estimating how many points we collect in the next ticks if we stand on a position, from
+// features of the forecast. The weights are fitted to self-play games by the evaluator_training tool and loaded from
+// evaluator.weights. Inference uses AVX2 when the bot is built with BOT_AVX2.
+class Evaluator {
+ public:
+  static const int inputs = 16;
+  static const int hidden = 16;
+  using Features = std::array<float, inputs>;
+
+  static Features features(AI& ai, Pos pos);
+  float evaluate(const Features& x) const;
+  float evaluate(AI& ai, Pos pos) const { return evaluate(features(ai, pos)); }
+  bool is_loaded() const { return loaded; }
+
+  // Plain gradient descent on the squared error
+  void train(const std::vector<std::pair<Features, float>>& samples, int epochs, float learning_rate);
+  void randomize(unsigned seed);
+
+  void save(std::ostream& out) const;
+  void load(std::istream& in);
+
+ private:
+  bool loaded = false;
+  alignas(32) std::array<std::array<float, hidden>, inputs> w1{};  // [input][hidden unit], so a row is one update
+  alignas(32) std::array<float, hidden> b1{};
+  alignas(32) std::array<float, hidden> w2{};
+  float b2 = 0;
+
+  void hidden_layer(const Features& x, std::array<float, hidden>& h) const;
+};
+
+#endif  // ITECH21_EVALUATOR_H
@@ -5,68 +5,79 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 #include "AI.h"
 
 using namespace std;
 
-const Objective::EvalResult not_applicable{{false, nullopt, nullopt}, 0, "Not applicable"};
+const Objective::EvalResult not_applicable{{false, nullopt, nullopt}, 0, [] { return string("Not applicable"); }};
 
-Objective::EvalResult BatObjective::evaluate(AI& ai, bool secondary) {
+int BatObjective::checked_candidates = 8;
+
+Objective::EvalResult BatObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
 
-  set<pair<int, Pos>> ordered_pos;
-  for (const Bat& bat : ai.state.bats) {
-    const auto& grenade_positions_for_bat = ai.grenade_positions_for(bat.pos);
-    for (const Pos& pos : grenade_positions_for_bat) {
-      ordered_pos.insert({manhattan_distance(ai.self.pos, pos), pos});
+  // Value of placing a grenade on each field: the bats its blast would hit when it explodes.
+  // The blast rays are symmetric, so the fields are collected by casting the rays from the bats.
+  const ReachabilityMap& reachability = ai.reachability();
+  int min_ticks = ai.ticks_to_wait_until_grenade();
+  // A field we can't walk to may still be thrown onto, a tick after we get to a field to throw from, the same way as
+  // find_path_to_place_grenade looks for them. Fields we can't get a grenade to either way are UNREACHABLE.
+  const Grid& throw_grid = ai.path_finder.grids()[ai.path_finder.trim_tick(min_ticks)];
+  unordered_map<Pos, int, Pos::hash> arrivals;
+  auto arrival = [&](Pos pos) {
+    auto known = arrivals.find(pos);
+    if (known != arrivals.end()) return known->second;
+    int tick = reachability.arrival(ai.self.id, pos);
+    if (tick == ReachabilityMap::UNREACHABLE) {
+      for (const Pos& from : throw_grid.from_where_can_throw_to(pos)) {
+        tick = min(tick, reachability.arrival(ai.self.id, from) + 1);
+      }
     }
-  }
-
-  int count = 0;
-  int max_dist = 0;
-  for (const auto& dist_pos : ordered_pos) {
-    max_dist = dist_pos.first;
-    count++;
-    if (count > 20) break;
-  }
-
-  map<Pos, vector<Bat>> possible_grenade_kills;
+    return arrivals[pos] = tick < ReachabilityMap::UNREACHABLE ? max(tick, min_ticks) : ReachabilityMap::UNREACHABLE;
+  };
+  unordered_map<Pos, pair<double, vector<Bat>>, Pos::hash> bat_values;
   for (const Bat& bat : ai.state.bats) {
-    const auto& grenade_positions_for_bat = ai.grenade_positions_for(bat.pos);
-    for (const Pos& pos : grenade_positions_for_bat) {
-      if (manhattan_distance(ai.self.pos, pos) > max_dist) continue;
-      auto grenade_pos = possible_grenade_kills.find(pos);
-      if (grenade_pos != possible_grenade_kills.end()) {
-        grenade_pos->second.push_back(bat);
-      } else {
-        possible_grenade_kills.insert(make_pair(pos, vector<Bat>{bat}));
-      }
+    for (const Pos& pos : ai.grenade_positions_for(bat.pos)) {
+      if (arrival(pos) == ReachabilityMap::UNREACHABLE) continue;
+      int explosion_tick = arrival(pos) + GRENADE_TICKS - 1;
+      if (!ai.path_finder.grids()[ai.path_finder.trim_tick(explosion_tick)].field_at(bat.pos).bat.has_value()) continue;
+      auto& value = bat_values[pos];
+      value.first += 1 + (bat.density == 1 ? 0.1 / 12 : 0);
+      value.second.push_back(bat);
     }
   }
 
-  // TODO unreachable positions should be filtered out before (performance only)
-  for (const auto& grenade_kill : possible_grenade_kills) {
+  // Ranked by the score we would get if the path to the field was the shortest one. This is only an order, not a
+  // bound on the score, so all the top candidates are checked.
+  vector<pair<double, Pos>> candidates;
+  for (const auto& [pos, value] : bat_values) candidates.emplace_back(12.0 * value.first / max(arrival(pos), 1), pos);
+  sort(candidates.begin(), candidates.end(), greater<>());
+
+  int checked = 0;
+  for (const auto& [estimate, grenade_pos] : candidates) {
+    if (checked >= checked_candidates || deadline.expired()) break;
     // Check if we have a grenade there and don't put another one.
     bool we_have_grenade = false;
-    const Field& field = ai.grid.field_at(grenade_kill.first);
+    const Field& field = ai.grid.field_at(grenade_pos);
     for (const auto& grenade : field.grenades) {
       if (grenade.vampire_id == ai.self.id) we_have_grenade = true;
     }
     if (we_have_grenade) continue;
+    ++checked;
     bool can_throw = (ai.grenade_owner_objective[ai.self.pos] == this);
-    auto path =
-        ai.path_finder.find_path_to_place_grenade(can_throw, grenade_kill.first, ai.ticks_to_wait_until_grenade());
+    auto path = ai.path_finder.find_path_to_place_grenade(can_throw, grenade_pos, min_ticks);
     if (!path.has_value()) continue;
     double score = 0;
     int explosion_tick = (int)path.value().size() + GRENADE_TICKS - 1;
     if (path.value().back().throw_grenades.has_value()) --explosion_tick;
     // This is a temp fix to avoid considering the original effect of the grenade that we throw.
     auto& grid_when_explodes = path.value().back().throw_grenades.has_value()
-                                   ? ai.path_finder.grids[0]
-                                   : ai.path_finder.grids[ai.path_finder.trim_tick(explosion_tick)];
+                                   ? ai.path_finder.grids()[0]
+                                   : ai.path_finder.grids()[ai.path_finder.trim_tick(explosion_tick)];
     vector<Bat> hit_bats;
-    for (const auto& bat : grenade_kill.second) {
+    for (const auto& bat : bat_values[grenade_pos].second) {
       auto& future_bat = grid_when_explodes.field_at(bat.pos).bat;
       if (future_bat.has_value()) {
         hit_bats.push_back(future_bat.value());
@@ -77,22 +88,45 @@ Objective::EvalResult BatObjective::evaluate(AI& ai, bool secondary) {
     if (score > result.score) {
       result.score = score;
       result.step = path.value()[0];
+      result.path = move(path.value());
+      result.target = grenade_pos;
 
-      result.description = "BatObjective: killing " + to_string(hit_bats.size()) + " bats (";
-      for (const auto& bat : hit_bats) {
-        result.description += to_string(bat.pos) + ",";
-      }
-      result.description += ") with placing grenade at " + to_string(grenade_kill.first) + " in " +
-                            to_string(path.value().size()) + " ticks.";
+      result.description = [hit_bats, grenade_pos, ticks = result.path.size()]() {
+        string description = "BatObjective: killing " + to_string(hit_bats.size()) + " bats (";
+        for (const auto& bat : hit_bats) {
+          description += to_string(bat.pos) + ",";
+        }
+        return description + ") with placing grenade at " + to_string(grenade_pos) + " in " + to_string(ticks) +
+               " ticks.";
+      };
     }
   }
 
   return result;
 }
 
-Objective::EvalResult PowerupObjective::evaluate(AI& ai, bool secondary) {
+bool BatObjective::is_plan_valid(AI& ai, const EvalResult& plan) {
+  for (const auto& grenade : ai.grid.field_at(plan.target).grenades) {
+    if (grenade.vampire_id == ai.self.id) return false;
+  }
+  const Grid& grid_when_explodes = ai.path_finder.grids().back();
+  for (const Pos& delta : pos_deltas) {
+    Pos pos = plan.target;
+    for (int i = 1; i <= ai.self.range; i++) {
+      pos += delta;
+      if (grid_when_explodes[pos].bat.has_value()) return true;
+      if (grid_when_explodes[pos].is_bush) break;
+    }
+  }
+  return false;
+}
+
+double PowerupObjective::outrun_success_probability = 0.5;
+
+Objective::EvalResult PowerupObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
   for (const Powerup& powerup : ai.state.powerups) {
+    if (deadline.expired()) break;
     if (ai.self.pos == powerup.pos && powerup.ticks >= 0 && ai.protect_steps >= powerup.protect) continue;
     int ticks_until_appears = powerup.ticks >= 0 ? 0 : -powerup.ticks - 1;
     auto path = ai.path_finder.find_path(
@@ -107,18 +141,32 @@ Objective::EvalResult PowerupObjective::evaluate(AI& ai, bool secondary) {
         powerup.type == PowerupType::SHOE) {
       score *= 2;
     }
+    int rival_arrival = max(ai.reachability().rival_arrival(ai.self.id, powerup.pos), ticks_until_appears);
+    bool outrun = ai.self.pos != powerup.pos && rival_arrival < max((int)path.value().size(), ticks_until_appears);
+    if (outrun) score *= outrun_success_probability;
     if (score > result.score) {
       result.score = score;
       result.step = path.value()[0];
+      result.path = move(path.value());
+      result.target = powerup.pos;
 
-      result.description =
-          "PowerupObjective: getting powerup at " + to_string(powerup.pos) + " in " + to_string(ticks) + " ticks.";
+      result.description = [pos = powerup.pos, ticks, outrun]() {
+        return "PowerupObjective: getting powerup at " + to_string(pos) + " in " + to_string(ticks) + " ticks" +
+               (outrun ? ", a rival gets there first." : ".");
+      };
     }
   }
   return result;
 }
 
-Objective::EvalResult PositioningObjective::evaluate(AI& ai, bool secondary) {
+bool PowerupObjective::is_plan_valid(AI& ai, const EvalResult& plan) {
+  for (const Powerup& powerup : ai.state.powerups) {
+    if (powerup.pos == plan.target) return plan.target != ai.self.pos;
+  }
+  return false;
+}
+
+Objective::EvalResult PositioningObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
   if (ai.offensive_mode) {  // follow
     for (const Vampire& vampire : ai.state.vampires) {
@@ -130,8 +178,9 @@ Objective::EvalResult PositioningObjective::evaluate(AI& ai, bool secondary) {
           result.score = score;
           result.step = path.value()[0];
 
-          result.description = "PositioningObjective: following V" + to_string(vampire.id) +
-                               " distance: " + to_string(path.value().size());
+          result.description = [id = vampire.id, distance = path.value().size()]() {
+            return "PositioningObjective: following V" + to_string(id) + " distance: " + to_string(distance);
+          };
         }
       }
     }
@@ -147,20 +196,20 @@ Objective::EvalResult PositioningObjective::evaluate(AI& ai, bool secondary) {
       double score = 0;
       for (const Vampire& vampire : ai.state.vampires) {
         if (vampire.id == ai.self.id) continue;
-        score += manhattan_distance(next_pos, vampire.pos);
+        score += min(ai.reachability().arrival(vampire.id, next_pos), 2 * n);
       }
       score = score / ((int)ai.state.vampires.size() - 1) / (2 * (int)ai.grid.fields.size());
       if (score > result.score) {
         result.score = score;
         result.step = (*path)[0];
-        result.description = "PositioningObjective: going towards corner " + to_string(corner);
+        result.description = [corner]() { return "PositioningObjective: going towards corner " + to_string(corner); };
       }
     }
   }
   return result;
 }
 
-Objective::EvalResult AttackObjective::evaluate(AI& ai, bool secondary) {
+Objective::EvalResult AttackObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   if (ai.protection || !ai.self.grenades || ai.self.pos.y % 2 == 0 || ai.self.pos.x % 2 == 0 || !ai.offensive_mode ||
       !ai.grid[ai.self.pos].grenades.empty())
     return not_applicable;
@@ -174,6 +223,7 @@ Objective::EvalResult AttackObjective::evaluate(AI& ai, bool secondary) {
   EvalResult result = not_applicable;
   if (close_opponents.empty()) return result;
   PathFinder grenade_planner;  // TODO use SafetyChecker
+  grenade_planner.deadline = deadline;
   grenade_planner.init_with_grenade_placed(ai.grid, ai.self, {0, {ai.self.pos}});
   grenade_planner.init_step_safety_checker(ai.state);
   if (!grenade_planner.is_survivable()) return result;
@@ -188,19 +238,21 @@ Objective::EvalResult AttackObjective::evaluate(AI& ai, bool secondary) {
              path.has_value() && path.value()[0].move.value() == vector<Direction>{*dir, *dir} ? path.value()[0].move
                                                                                                : nullopt},
             score,
-            "Trapping V" + to_string(vampire.id)};
+            [id = vampire.id] { return "Trapping V" + to_string(id); }};
       }
     } else if (manhattan_distance(ai.self.pos, vampire.pos) == 2 &&
                ai.grid[ai.self.pos + pos_deltas[(int)*dir]].can_step_here()) {
       if (score > result.score) {
-        result = {{true, nullopt, nullopt}, score, "Attacking V" + to_string(vampire.id)};
+        result = {{true, nullopt, nullopt}, score, [id = vampire.id] { return "Attacking V" + to_string(id); }};
       }
     }
   }
   return result;
 }
 
-Objective::EvalResult AttackObjective2::evaluate(AI& ai, bool secondary) {
+int AttackObjective2::enemy_width = 4;
+
+Objective::EvalResult AttackObjective2::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
 
   auto is_move_valid = [&ai](const Vampire& vampire, const vector<Direction>& move) {
@@ -254,76 +306,145 @@ Objective::EvalResult AttackObjective2::evaluate(AI& ai, bool secondary) {
     return options;
   };
 
+  // The vampire's position after making move, if nothing blocks it
+  auto destination_of = [](const Vampire& vampire, const vector<Direction>& move) {
+    Pos pos = vampire.pos;
+    for (Direction dir : move) pos += pos_deltas[(int)dir];
+    return pos;
+  };
+
   auto enemies = ai.grid.get_enemies(ai.self.id);
   enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
-                               [&ai](const Vampire& enemy) {
-                                 PathFinder pf;
-                                 pf.init(ai.grid, enemy);
-                                 return !pf.is_survivable();
-                               }),
+                               [&ai](const Vampire& enemy) { return manhattan_distance(enemy.pos, ai.self.pos) > 6; }),
                 enemies.end());
 
+  // The valid moves of an enemy that it survives if we don't interfere, grouped by destination. Moves with the same
+  // destination end in the same grid, and none of this depends on our grenade option, so each destination is simulated
+  // only once per tick. An enemy without such moves dies anyway, so it is not worth attacking. Once the opponent model
+  // knows the situation of the enemy, only its enemy_width most likely surviving destinations are kept.
+  unordered_map<int, map<Pos, vector<vector<Direction>>>> surviving_moves;
+  // The moves to a destination share its probability
+  unordered_map<int, map<Pos, double>> destination_probabilities;
+  for (const auto& enemy : enemies) {
+    map<Pos, vector<vector<Direction>>> moves_by_destination;
+    for (const auto& enemy_move : moves_3) {
+      if (is_move_valid(enemy, enemy_move))
+        moves_by_destination[destination_of(enemy, enemy_move)].push_back(enemy_move);
+    }
+    vector<Pos> destinations;
+    for (const auto& destination_moves : moves_by_destination) destinations.push_back(destination_moves.first);
+    bool prune = ai.opponent_model.knows(ai.grid, enemy, ai.self.pos);
+    for (const auto& [destination, probability] :
+         ai.opponent_model.predict(ai.grid, enemy, ai.self.pos, destinations)) {
+      if (prune && (int)surviving_moves[enemy.id].size() == enemy_width) break;
+      if (deadline.expired()) return result;
+      const auto& moves = moves_by_destination[destination];
+      Grid new_grid = Grid{ai.grid};
+      new_grid.step({{enemy.id, Step{false, nullopt, moves[0]}}});
+      const auto& enemy_future = new_grid.get_vampire(enemy.id);
+      if (!enemy_future.has_value()) continue;
+      PathFinder pf;
+      pf.deadline = deadline;
+      pf.init(new_grid, enemy_future.value());
+      // Dies whithout us
+      if (!pf.is_survivable()) continue;
+      surviving_moves[enemy.id][destination] = moves;
+      destination_probabilities[enemy.id][destination] = probability;
+    }
+  }
+
   const auto& self_granade_options = get_granade_options(ai.self);
   for (const auto& self_granade_option : self_granade_options) {
     auto self_step = Step{self_granade_option.first, self_granade_option.second, nullopt};
-    for (const auto& enemy : enemies) {
-      if (manhattan_distance(enemy.pos, ai.self.pos) > 6) continue;
-      int enemy_possible_moves = 0;
-      int enemy_fatal_moves = 0;
-      for (const auto& enemy_move : moves_3) {
-        if (is_move_valid(enemy, enemy_move)) {
-          {
-            Grid new_grid = Grid{ai.grid};
-            new_grid.step({{enemy.id, Step{false, nullopt, enemy_move}}});
-            const auto& enemy_future = new_grid.get_vampire(enemy.id);
-            PathFinder pf;
-            if (!enemy_future.has_value()) continue;
-            pf.init(new_grid, enemy_future.value());
-            // Dies whithout us
-            if (!pf.is_survivable()) continue;
-          }
+    // Our new grenade can stop an enemy on its way, we can't merge the moves that pass it
+    vector<Pos> new_grenade_positions;
+    if (self_granade_option.first) new_grenade_positions.push_back(ai.self.pos);
+    if (self_granade_option.second.has_value()) {
+      const Throw& thro = self_granade_option.second.value();
+      Pos from_pos = thro.from_place ? ai.self.pos : ai.self.pos + pos_deltas[(int)thro.dir];
+      new_grenade_positions.push_back(from_pos + thro.length * pos_deltas[(int)thro.dir]);
+    }
+    auto crosses_new_grenade = [&](const Vampire& enemy, const vector<Direction>& move) {
+      Pos pos = enemy.pos;
+      for (Direction dir : move) {
+        pos += pos_deltas[(int)dir];
+        if (find(new_grenade_positions.begin(), new_grenade_positions.end(), pos) != new_grenade_positions.end())
+          return true;
+      }
+      return false;
+    };
+
+    // PathFinder doesn't see the other vampires, and the enemy moves below place no grenades, so where the enemies go
+    // doesn't change whether we survive our step. It is checked once, with them staying.
+    {
+      Grid new_grid = Grid{ai.grid};
+      new_grid.step({{ai.self.id, self_step}});
+      const auto& self_future = new_grid.get_vampire(ai.self.id);
+      if (!self_future.has_value()) continue;
+      PathFinder pf;
+      pf.deadline = deadline;
+      pf.init(new_grid, self_future.value());
+      if (!pf.is_survivable()) continue;
+    }
 
-          Grid new_grid = Grid{ai.grid};
-          new_grid.step({{ai.self.id, self_step}, {enemy.id, Step{false, nullopt, enemy_move}}});
-          // new_grid.print(cerr);
-          const auto& enemy_future = new_grid.get_vampire(enemy.id);
-          bool fatal_for_enemy = !enemy_future.has_value();
-          if (!fatal_for_enemy) {
-            PathFinder pf;
-            pf.init(new_grid, enemy_future.value());
-            fatal_for_enemy = !pf.is_survivable();
+    for (const auto& enemy : enemies) {
+      if (deadline.expired()) return result;
+      // Enemy moves with the same outcome together with our step, and their probability
+      vector<pair<vector<Direction>, double>> joint_moves;
+      for (const auto& [destination, probability] : destination_probabilities[enemy.id]) {
+        const auto& enemy_moves = surviving_moves[enemy.id][destination];
+        double move_probability = probability / enemy_moves.size();
+        int merged_idx = -1;
+        for (const auto& enemy_move : enemy_moves) {
+          if (crosses_new_grenade(enemy, enemy_move)) {
+            joint_moves.emplace_back(enemy_move, move_probability);
+          } else if (merged_idx == -1) {
+            merged_idx = (int)joint_moves.size();
+            joint_moves.emplace_back(enemy_move, move_probability);
+          } else {
+            joint_moves[merged_idx].second += move_probability;
           }
+        }
+      }
 
-          const auto& self_future = new_grid.get_vampire(ai.self.id);
-          if (!self_future.has_value()) goto unsafe_choice;
-          {
-            PathFinder pf;
-            pf.init(new_grid, self_future.value());
-            if (!pf.is_survivable()) goto unsafe_choice;
-          }
+      double enemy_possible_moves = 0;
+      double enemy_fatal_moves = 0;
+      for (const auto& joint_move : joint_moves) {
+        Grid new_grid = Grid{ai.grid};
+        new_grid.step({{ai.self.id, self_step}, {enemy.id, Step{false, nullopt, joint_move.first}}});
+        // new_grid.print(cerr);
+        const auto& enemy_future = new_grid.get_vampire(enemy.id);
+        bool fatal_for_enemy = !enemy_future.has_value();
+        if (!fatal_for_enemy) {
+          PathFinder pf;
+          pf.deadline = deadline;
+          pf.init(new_grid, enemy_future.value());
+          fatal_for_enemy = !pf.is_survivable();
+        }
 
-          enemy_possible_moves++;
-          if (fatal_for_enemy) {
-            // cerr << "FATAL" << endl;
-            enemy_fatal_moves++;
-          }
+        enemy_possible_moves += joint_move.second;
+        if (fatal_for_enemy) {
+          // cerr << "FATAL" << endl;
+          enemy_fatal_moves += joint_move.second;
         }
       }
 
+      // Interrupted simulations look fatal for everyone, don't trust the partial counts
+      if (deadline.expired()) return result;
       if (enemy_possible_moves > 0) {
-        int score = (enemy.health == 1 ? 144 : 48) * enemy_fatal_moves / enemy_possible_moves;
+        int score = (int)((enemy.health == 1 ? 144 : 48) * enemy_fatal_moves / enemy_possible_moves);
         // cerr << "RESULT " << enemy.id << " " << enemy_fatal_moves << "/" << enemy_possible_moves << " " << score <<
         // endl;
         if (score > result.score) {
           result.score = score;
           result.step = self_step;
-          result.description = "AttackObjective2: attacking vampire #" + to_string(enemy.id) +
-                               " possibility: " + to_string(enemy_fatal_moves) + "/" + to_string(enemy_possible_moves);
+          result.description = [id = enemy.id, percent = (int)(100 * enemy_fatal_moves / enemy_possible_moves)]() {
+            return "AttackObjective2: attacking vampire #" + to_string(id) + " possibility: " + to_string(percent) +
+                   "%";
+          };
         }
       }
     }
-  unsafe_choice:
-    continue;
   }
 
   return result;
@@ -331,9 +452,9 @@ Objective::EvalResult AttackObjective2::evaluate(AI& ai, bool secondary) {
 
 double ChainAttackObjective::yolo_grenade_score = 5;
 
-Objective::EvalResult ChainAttackObjective::evaluate(AI& ai, bool secondary) {
+Objective::EvalResult ChainAttackObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
-  if (ai.path_finder.grids[1][ai.self.pos].has_light && ai.self.grenades > 0) {
+  if (ai.path_finder.grids()[1][ai.self.pos].has_light && ai.self.grenades > 0) {
     bool can_throw = (ai.grenade_owner_objective[ai.self.pos] == this);
     auto path = ai.path_finder.find_path_to_place_grenade(can_throw, ai.self.pos, 0, 1);
     if (path.has_value() && path.value().size() == 1) {
@@ -341,7 +462,7 @@ Objective::EvalResult ChainAttackObjective::evaluate(AI& ai, bool secondary) {
     }
   }
   for (const auto& throw_option : ai.throw_options_from(ai.self.pos)) {
-    if (ai.path_finder.grids[1][throw_option.target_pos].has_light) {
+    if (ai.path_finder.grids()[1][throw_option.target_pos].has_light) {
       bool can_throw = (ai.grenade_owner_objective[ai.self.pos] == this);
       auto path = ai.path_finder.find_path_to_place_grenade(can_throw, throw_option.target_pos, 0, 1);
       if (path.has_value() && path.value().size() == 1) {
@@ -404,26 +525,29 @@ void ChainAttackObjective::update_result(Objective::EvalResult& result, double s
       mode_str = "yolo";
       break;
   }
-  result.description = "ChainAttackObjective ("s + mode_str + "): attacking with grenade at " + to_string(attack_pos);
+  result.description = [mode_str, attack_pos]() {
+    return "ChainAttackObjective ("s + mode_str + "): attacking with grenade at " + to_string(attack_pos);
+  };
 }
 
 double AttackPowerupObjective::success_probability = 0.5;
 double AttackPowerupObjective::indirect_success_probability = 0.75;
 
-Objective::EvalResult AttackPowerupObjective::evaluate(AI& ai, bool secondary) {
+Objective::EvalResult AttackPowerupObjective::evaluate(AI& ai, bool secondary, const Deadline& deadline) {
   EvalResult result;
   for (const Powerup& powerup : ai.state.powerups) {
+    if (deadline.expired()) break;
     int ticks_until_appears = powerup.ticks >= 0 ? 0 : -powerup.ticks - 1;
     if (ticks_until_appears == 0) continue;
     int other_attacker_count = 0;
-    if ((int)ai.path_finder.grids.size() > ticks_until_appears) {
-      if (ai.path_finder.grids[ticks_until_appears][powerup.pos].illuminated_by_vampire.count(ai.self.id)) continue;
-      other_attacker_count = ai.path_finder.grids[ticks_until_appears][powerup.pos].illuminated_by_vampire.size();
+    if ((int)ai.path_finder.grids().size() > ticks_until_appears) {
+      if (ai.path_finder.grids()[ticks_until_appears][powerup.pos].illuminated_by_vampire.count(ai.self.id)) continue;
+      other_attacker_count = ai.path_finder.grids()[ticks_until_appears][powerup.pos].illuminated_by_vampire.size();
     }
     int rival_count = 0;
-    for (auto& opponent : ai.opponent_path_finders) {
-      auto opponent_path = opponent.second.find_path(powerup.pos, ticks_until_appears);
-      rival_count += opponent_path.has_value() && (int)opponent_path->size() <= ticks_until_appears;
+    for (const Vampire& opponent : ai.state.vampires) {
+      if (opponent.id == ai.self.id) continue;
+      rival_count += ai.reachability().arrival(opponent.id, powerup.pos) <= ticks_until_appears;
     }
     if (rival_count == 0) continue;
     int ticks_until_grenade_placement = ticks_until_appears - GRENADE_TICKS;
@@ -436,8 +560,8 @@ Objective::EvalResult AttackPowerupObjective::evaluate(AI& ai, bool secondary) {
         for (const Pos& pos : position_sets[pos_set]) {
           bool illuminated_too_soon = false;
           for (int tick = ticks_until_grenade_placement + 1;
-               !illuminated_too_soon && tick < min((int)ai.path_finder.grids.size(), ticks_until_appears); ++tick) {
-            illuminated_too_soon = ai.path_finder.grids[tick][pos].has_light;
+               !illuminated_too_soon && tick < min((int)ai.path_finder.grids().size(), ticks_until_appears); ++tick) {
+            illuminated_too_soon = ai.path_finder.grids()[tick][pos].has_light;
           }
           if (!illuminated_too_soon) {
             bool can_throw = (ai.grenade_owner_objective[ai.self.pos] == this);
@@ -454,8 +578,8 @@ Objective::EvalResult AttackPowerupObjective::evaluate(AI& ai, bool secondary) {
       }
     }
     for (const Pos& pos : grenade_positions) {
-      if ((int)ai.path_finder.grids.size() > ticks_until_appears &&
-          ai.path_finder.grids[ticks_until_appears][pos].has_light) {  // indirect attack
+      if ((int)ai.path_finder.grids().size() > ticks_until_appears &&
+          ai.path_finder.grids()[ticks_until_appears][pos].has_light) {  // indirect attack
         bool can_throw = (ai.grenade_owner_objective[ai.self.pos] == this);
         auto path = ai.path_finder.find_path_to_place_grenade(can_throw, pos, ticks_until_appears - 1);
         double score =
@@ -486,6 +610,8 @@ void AttackPowerupObjective::update_result(Objective::EvalResult& result, double
       mode_str = "setup";
       break;
   }
-  result.description = "AttackPowerupObjective ("s + mode_str + "): attacking powerup at " + to_string(powerup_pos) +
-                       " in " + to_string(path.size()) + " ticks.";
+  result.description = [mode_str, powerup_pos, ticks = path.size()]() {
+    return "AttackPowerupObjective ("s + mode_str + "): attacking powerup at " + to_string(powerup_pos) + " in " +
+           to_string(ticks) + " ticks.";
+  };
 }
@@ -1,10 +1,13 @@
 #ifndef ITECH21_OBJECTIVE_H
 #define ITECH21_OBJECTIVE_H
 
+#include <functional>
+#include <string>
 #include <vector>
 
 #include "../common/GameState.h"
 #include "../common/Grid.h"
+#include "Deadline.h"
 
 class AI;
 
@@ -13,34 +16,50 @@ class Objective {
   struct EvalResult {
     Step step;
     double score = 0.0;
-    std::string description = "";
+    std::function<std::string()> description{};  // built only for the results that get logged
+    std::vector<Step> path{};  // the whole plan starting with step, empty if it can't be followed over more ticks
+    Pos target{};
+
+    std::string describe() const { return description ? description() : ""; }
   };
-  virtual EvalResult evaluate(AI& ai, bool secondary) = 0;
+  // Returns the best result found before the deadline expires
+  virtual EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) = 0;
+  // Cheap check whether the target of a plan returned earlier is still worth going for
+  virtual bool is_plan_valid(AI& ai, const EvalResult& plan) { return false; }
+  virtual ~Objective() = default;
 };
 
 class BatObjective : public Objective {
+  static int checked_candidates;  // grenade positions that get the full path and survivability check
+
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
+  bool is_plan_valid(AI& ai, const EvalResult& plan) override;
 };
 
 class PowerupObjective : public Objective {
+  static double outrun_success_probability;  // if another vampire can get there first
+
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
+  bool is_plan_valid(AI& ai, const EvalResult& plan) override;
 };
 
 class PositioningObjective : public Objective {
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
 };
 
 class AttackObjective : public Objective {
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
 };
 
 class AttackObjective2 : public Objective {
+  static int enemy_width;  // the most likely destinations of an enemy that are simulated
+
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
 };
 
 class ChainAttackObjective : public Objective {
@@ -50,7 +69,7 @@ class ChainAttackObjective : public Objective {
   double evaluateChainAttackPos(const AI& ai, const Pos& grenade_pos);
 
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
 };
 
 class AttackPowerupObjective : public Objective {
@@ -61,7 +80,7 @@ class AttackPowerupObjective : public Objective {
                             AttackMode attack_mode);
 
  public:
-  EvalResult evaluate(AI& ai, bool secondary) override;
+  EvalResult evaluate(AI& ai, bool secondary, const Deadline& deadline) override;
 };
 
 #endif  // ITECH21_OBJECTIVE_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+
+#include "../common/Symmetry.h"
+
+using namespace std;
+
+void OpeningBook::add(const GameState& state, int size, const Step& step) {
+  CanonicalKey canonical = canonical_key(state, size, state.vampire_id);
+  canonical.key.push_back((char)size);
+  book.emplace(move(canonical.key), canonical.transform.apply(step));
+  depth = book.size() == 1 ? state.tick : max(depth, state.tick);
+}
+
+optional<Step> OpeningBook::lookup(const GameState& state, int size) const {
+  if (book.empty() || state.tick > depth) return nullopt;
+  CanonicalKey canonical = canonical_key(state, size, state.vampire_id);
+  canonical.key.push_back((char)size);
+  auto it = book.find(canonical.key);
+  if (it == book.end()) return nullopt;
+  return canonical.transform.inverse().apply(it->second);
+}
+
+void OpeningBook::save(ostream& out) const {
+  static const char* digits = "0123456789abcdef";
+  out << "depth " << depth << '\n';
+  for (const auto& [key, step] : book) {
+    for (char c : key) out << digits[(unsigned char)c >> 4] << digits[c & 15];
+    out << ' ' << encode(step) << '\n';
+  }
+}
+
+void OpeningBook::load(istream& in) {
+  string hex, code;
+  while (in >> hex >> code) {
+    if (hex == "depth") {
+      depth = stoi(code);
+      continue;
+    }
+    string key;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) key.push_back((char)stoi(hex.substr(i, 2), nullptr, 16));
+    book[key] = decode(code);
+  }
+}
+
+// <grenade>:<move>, where grenade is G for placing, T[X]<direction><length> for throwing, - for nothing,
+// and move is the directions, . for staying or - for no move
+string OpeningBook::encode(const Step& step) {
+  string code = "-";
+  if (step.place_grenade) {
+    code = "G";
+  } else if (step.throw_grenades.has_value()) {
+    code = string("T") + (step.throw_grenades->from_place ? "X" : "") + "URDL"[(int)step.throw_grenades->dir] +
+           to_string(step.throw_grenades->length);
+  }
+  code += ':';
+  if (!step.move.has_value()) return code + '-';
+  if (step.move->empty()) return code + '.';
+  for (Direction dir : step.move.value()) code += "URDL"[(int)dir];
+  return code;
+}
+
+Step OpeningBook::decode(const string& code) {
+  const string letters = "URDL";
+  Step step;
+  size_t i = 0;
+  if (code[i] == 'G') {
+    step.place_grenade = true;
+    ++i;
+  } else if (code[i] == 'T') {
+    Throw thro;
+    thro.from_place = code[++i] == 'X';
+    if (thro.from_place) ++i;
+    thro.dir = (Direction)letters.find(code[i++]);
+    thro.length = code[i++] - '0';
+    step.throw_grenades = thro;
+  } else {
+    ++i;
+  }
+  ++i;  // ':'
+  if (code[i] == '-') return step;
+  step.move = vector<Direction>();
+  for (; i < code.size() && code[i] != '.'; ++i) step.move->push_back((Direction)letters.find(code[i]));
+  return step;
+}
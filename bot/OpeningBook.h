@@ -0,0 +1,34 @@
+#ifndef ITECH21_OPENINGBOOK_H
+#define ITECH21_OPENINGBOOK_H
+
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "../common/GameState.h"
+
+// The steps played in the first ticks of self-play games, see opening_book.cpp.
+// Positions are stored by their canonical key, so symmetric starts share their entries.
+class OpeningBook {
+ public:
+  // Keeps the first step added for a state, so the games building the book follow the same line as the bot
+  void add(const GameState& state, int size, const Step& step);
+  std::optional<Step> lookup(const GameState& state, int size) const;
+
+  void save(std::ostream& out) const;
+  void load(std::istream& in);
+  size_t size() const { return book.size(); }
+
+ private:
+  std::unordered_map<std::string, Step> book;
+  // The last tick with an entry, states after it are not looked up. Unknown for the books saved without it.
+  int depth = std::numeric_limits<int>::max();
+
+  static std::string encode(const Step& step);
+  static Step decode(const std::string& code);
+};
+
+#endif  // ITECH21_OPENINGBOOK_H
@@ -0,0 +1,96 @@
+#include "OpponentModel.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Bits: the enemy stands in the blast of a grenade, has shoes, has grenades, is close to us, and the length of its
+// last move
+int OpponentModel::feature_of(const Grid& grid, const Vampire& enemy, Pos self_pos) const {
+  bool in_blast = !grid[enemy.pos].grenades.empty();
+  int size = grid.fields.size();
+  for (Pos delta : pos_deltas) {
+    Pos pos = enemy.pos;
+    for (int distance = 1; !in_blast; ++distance) {
+      pos += delta;
+      if (pos.y < 0 || pos.x < 0 || pos.y >= size || pos.x >= size || grid[pos].is_bush) break;
+      for (const Grenade& grenade : grid[pos].grenades) in_blast |= grenade.range >= distance;
+    }
+  }
+  auto length = last_length.find(enemy.id);
+  return in_blast | (enemy.shoes > 0) << 1 | (enemy.grenades > 0) << 2 |
+         (manhattan_distance(enemy.pos, self_pos) <= 3) << 3 | (length == last_length.end() ? 0 : length->second) << 4;
+}
+
+// Staying, or the length of the move and whether it gets closer to, keeps the distance from or gets farther from us
+int OpponentModel::kind_of(Pos from, Pos to, Pos self_pos) {
+  int length = manhattan_distance(from, to);
+  if (length == 0) return 0;
+  int change = manhattan_distance(to, self_pos) - manhattan_distance(from, self_pos);
+  return 1 + (min(length, 3) - 1) * 3 + (change > 0) - (change < 0) + 1;
+}
+
+void OpponentModel::observe(const Grid& grid, int self_id) {
+  auto self = grid.get_vampire(self_id);
+  if (!self.has_value()) return;
+  bool continues = grid.tick == last_tick + 1;
+  map<int, pair<Pos, int>> seen;
+  for (const Vampire& enemy : grid.get_enemies(self_id)) {
+    auto last = last_seen.find(enemy.id);
+    if (continues && last != last_seen.end()) {
+      int length = manhattan_distance(last->second.first, enemy.pos);
+      // Longer jumps are respawns
+      if (length <= 3) {
+        ++counts[last->second.second][kind_of(last->second.first, enemy.pos, last_self_pos)];
+        last_length[enemy.id] = length;
+      }
+    }
+    seen[enemy.id] = {enemy.pos, feature_of(grid, enemy, self->pos)};
+  }
+  last_seen = move(seen);
+  last_self_pos = self->pos;
+  last_tick = grid.tick;
+}
+
+bool OpponentModel::knows(const Grid& grid, const Vampire& enemy, Pos self_pos) const {
+  const auto& row = counts[feature_of(grid, enemy, self_pos)];
+  int observations = 0;
+  for (int count : row) observations += count;
+  return observations >= min_observations;
+}
+
+vector<pair<Pos, double>> OpponentModel::predict(const Grid& grid, const Vampire& enemy, Pos self_pos,
+                                                 const vector<Pos>& destinations, int k) const {
+  const auto& row = counts[feature_of(grid, enemy, self_pos)];
+  bool known = knows(grid, enemy, self_pos);
+  array<int, kinds> destinations_of_kind{};
+  for (Pos destination : destinations) ++destinations_of_kind[kind_of(enemy.pos, destination, self_pos)];
+
+  vector<pair<Pos, double>> result;
+  double total = 0;
+  for (Pos destination : destinations) {
+    int kind = kind_of(enemy.pos, destination, self_pos);
+    double probability = known ? (row[kind] + 1.0) / destinations_of_kind[kind] : 1;
+    result.emplace_back(destination, probability);
+    total += probability;
+  }
+  for (auto& destination : result) destination.second /= total;
+  if (known) {
+    stable_sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (k < (int)result.size()) result.resize(k);
+  }
+  return result;
+}
+
+void OpponentModel::save(ostream& out) const {
+  for (const auto& row : counts) {
+    for (int kind = 0; kind < kinds; ++kind) out << row[kind] << (kind + 1 < kinds ? ' ' : '\n');
+  }
+}
+
+void OpponentModel::load(istream& in) {
+  for (auto& row : counts) {
+    for (int& count : row) in >> count;
+  }
+  if (!in) counts = {};
+}
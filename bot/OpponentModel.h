@@ -0,0 +1,50 @@
+#ifndef ITECH21_OPPONENTMODEL_H
+#define ITECH21_OPPONENTMODEL_H
+
+#include <array>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "../common/positions.h"
+
+// How often the enemies make each kind of move in each situation, trained from player*.in.log files by the
+// opponent_model tool and updated during the game. A kind of move is its length and whether it takes the enemy closer
+// to us, a situation is a few bits about the enemy, see feature_of.
+class OpponentModel {
+ public:
+  static const int full_width = std::numeric_limits<int>::max();
+  static const int min_observations = 20;  // below this the predictions are uniform and nothing is pruned
+
+  // Learns from the moves the enemies made since the previous tick. grid is the forecast AI::set_state builds.
+  void observe(const Grid& grid, int self_id);
+  // Whether the situation of enemy has been seen often enough to prune its unlikely moves
+  bool knows(const Grid& grid, const Vampire& enemy, Pos self_pos) const;
+  // The destinations of enemy with their probabilities, the destinations of the same kind share its probability
+  // evenly. If the situation is known, they are ordered by probability and only the k most likely are returned.
+  std::vector<std::pair<Pos, double>> predict(const Grid& grid, const Vampire& enemy, Pos self_pos,
+                                              const std::vector<Pos>& destinations, int k = full_width) const;
+
+  void save(std::ostream& out) const;
+  void load(std::istream& in);
+
+ private:
+  static const int features = 64;
+  static const int kinds = 10;
+
+  std::array<std::array<int, kinds>, features> counts{};
+  int last_tick = -1;
+  Pos last_self_pos;
+  std::map<int, std::pair<Pos, int>> last_seen;  // enemy id -> position, feature
+  std::map<int, int> last_length;                // enemy id -> length of its last move
+
+  int feature_of(const Grid& grid, const Vampire& enemy, Pos self_pos) const;
+  static int kind_of(Pos from, Pos to, Pos self_pos);
+};
+
+#endif  // ITECH21_OPPONENTMODEL_H
@@ -11,20 +11,20 @@ const int PathFinder::INF;
 
 void PathFinder::init(const Grid& starting_grid, Vampire self, bool _previous_obj_placed_grenade) {
   this->self = self;
-  grids.clear();
-  grids.push_back(starting_grid);
-  init_internals(GRENADE_TICKS);
+  forecast = make_forecast(starting_grid, GRENADE_TICKS);
+  timeline.init(forecast, HORIZON);
+  init_internals();
   previous_obj_placed_grenade = _previous_obj_placed_grenade;
 }
 
 void PathFinder::init_step_safety_checker(const GameState& state) {
-  if (grids.empty()) {
+  if (!forecast) {
     error("init_step_safety_checker error: PathFinder is not initialized");
   }
   if (!step_safety_checker) {
     step_safety_checker = make_unique<SafetyChecker>();
   }
-  step_safety_checker->init(state, grids[0], self);
+  step_safety_checker->init(state, grids()[0], self);
 }
 
 int PathFinder::get_distance(Pos target) {
@@ -38,8 +38,8 @@ optional<vector<Step>> PathFinder::find_path(Pos target, int min_ticks, int max_
   }
   dijkstra(target, min_ticks);
   if (distance[target.y][target.x] > max_ticks) return nullopt;
-  int tick = trim_tick(max(distance[target.y][target.x], min_ticks));
-  while (tick < (int)grids.size() - 1 && last_move[tick][target.y][target.x] == -1) {
+  int tick = trim_layer(max(distance[target.y][target.x], min_ticks));
+  while (tick < timeline.length() - 1 && last_move[tick][target.y][target.x] == -1) {
     ++tick;
   }
   if (distance[target.y][target.x] == INF || last_move[tick][target.y][target.x] == -1) {
@@ -69,19 +69,20 @@ optional<vector<Step>> PathFinder::find_path(Pos target, int min_ticks, int max_
 optional<vector<Step>> PathFinder::find_path_to_place_grenade(bool can_throw, Pos target, int min_ticks,
                                                               int max_ticks) {
   // We can throw a grenade onto another one, so skipping this check
-  // for (const auto& grenade : grids[0][target].grenades) {
+  // for (const auto& grenade : grids()[0][target].grenades) {
   //   min_ticks = max(min_ticks, grenade.tick);
   // }
 
   // Check whether we are standing on a grenade that we can throw
   auto maybe_throw = Throw::between(self.pos, target);
-  if (can_throw && maybe_throw.has_value() && maybe_throw.value().length <= grids[0].max_throw_length) {
-    for (const auto& grenade : grids[0][self.pos].grenades) {
+  if (can_throw && maybe_throw.has_value() && maybe_throw.value().length <= grids()[0].max_throw_length) {
+    for (const auto& grenade : grids()[0][self.pos].grenades) {
       if (grenade.vampire_id == self.id) {
         Step step{false, maybe_throw.value(), nullopt};
-        Grid new_grid{grids[0]};
+        Grid new_grid{grids()[0]};
         new_grid.step({{self.id, step}});
         PathFinder grenade_planner;
+        grenade_planner.deadline = deadline;
         grenade_planner.init(new_grid, self);
         if (grenade_planner.is_survivable()) return vector<Step>{step};
       }
@@ -92,7 +93,7 @@ optional<vector<Step>> PathFinder::find_path_to_place_grenade(bool can_throw, Po
   auto target_path = find_path(target, min_ticks, max_ticks);
   if (target_path.has_value()) candidates.emplace_back(target_path.value().size() * 2, target);
 
-  vector<Pos> throw_from = grids[trim_tick(min_ticks)].from_where_can_throw_to(target);
+  vector<Pos> throw_from = grids()[trim_tick(min_ticks)].from_where_can_throw_to(target);
   for (const auto& pos : throw_from) {
     auto throw_path = find_path(pos, max(0, min_ticks - 1), max_ticks);
     // We should add 1 to the path length. With the priority of (2 * path length) + 1,
@@ -105,13 +106,14 @@ optional<vector<Step>> PathFinder::find_path_to_place_grenade(bool can_throw, Po
     const Pos& pos = candidate.second;
     auto path = find_path(pos, max(0, min_ticks - (pos != target)), max_ticks);
     // If we put down the grenade and want to stay there to throw, there should not be light
-    if (pos != target && grids[trim_tick(path.value().size() + 1)][pos].has_light) continue;
+    if (pos != target && timeline.has_light(path.value().size() + 1, pos)) continue;
     // We check the placed grenade after throwing, at the target position
     TickPos at{(int)path.value().size() + (pos != target), target};
     Vampire future_self = self;
     future_self.pos = pos;
     PathFinder grenade_planner;  // TODO use SafetyChecker
-    grenade_planner.init_with_grenade_placed(grids[trim_tick(at.tick)], future_self, at);
+    grenade_planner.deadline = deadline;
+    grenade_planner.init_with_grenade_placed(grids()[trim_tick(at.tick)], future_self, at);
     if (!grenade_planner.is_survivable()) continue;
     // TODO if the path is short, try placing the grenade 1..GRENADE_TICKS later
     // (because a nearby grenade can interfere with our placement)
@@ -133,6 +135,36 @@ bool PathFinder::is_survivable() {
   return safe_path_exists;
 }
 
+bool PathFinder::is_path_valid(const vector<Step>& path) {
+  Pos pos = self.pos;
+  for (int tick = 0; tick < (int)path.size(); ++tick) {
+    const Step& step = path[tick];
+    if (step.place_grenade || step.throw_grenades.has_value()) break;
+    auto move = find(moves_3.begin(), moves_3.end(), step.move.value_or(vector<Direction>{}));
+    if (move == moves_3.end() || (tick >= self.shoes && move->size() > 2)) return false;
+    if (!do_move(pos, move - moves_3.begin(), tick) || timeline.has_light(tick + 1, pos)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Step PathFinder::find_escape_step() {
+  // Paths explored by an earlier successful search are marked visited without being proven unsafe
+  int size = grids()[0].fields.size();
+  dfs_vis.assign(timeline.length(), vector<vector<bool>>(size, vector<bool>(size)));
+  safe_path_exists = false;
+  for (int move_idx = 0; move_idx < (int)moves_3.size(); move_idx++) {
+    if (self.shoes == 0 && moves_3[move_idx].size() > 2) break;
+    Pos pos = self.pos;
+    if (do_move(pos, move_idx, 0) && !timeline.has_light(1, pos)) {
+      dfs_to_survive({1, pos});
+      if (safe_path_exists) return {false, nullopt, moves_3[move_idx]};
+    }
+  }
+  return {false, nullopt, vector<Direction>{}};
+}
+
 void PathFinder::set_heuristic(QueueEntry& entry) {
   // We take the elapsed ticks, prioritize some positions
   entry.heuristic = 5 * entry.tick;
@@ -141,7 +173,7 @@ void PathFinder::set_heuristic(QueueEntry& entry) {
   int curr_tick = trim_tick(entry.tick);
   for (Pos delta : pos_deltas) {
     Pos neighbor = entry.pos + delta;
-    if (grids[curr_tick][neighbor].can_step_here()) {
+    if (grids()[curr_tick][neighbor].can_step_here()) {
       good_neighbors++;
     }
   }
@@ -149,20 +181,20 @@ void PathFinder::set_heuristic(QueueEntry& entry) {
 }
 
 void PathFinder::dijkstra(Pos target, int min_ticks, int max_ticks) {
-  int check_at_tick = trim_tick(min_ticks);
+  int check_at_tick = trim_layer(min_ticks);
   while (!dijkstra_queue.empty() &&
          (distance[target.y][target.x] == INF || last_move[check_at_tick][target.y][target.x] == -1) &&
-         dijkstra_queue.top().tick <= max_ticks) {
+         dijkstra_queue.top().tick <= max_ticks && !deadline.expired()) {
     QueueEntry curr = dijkstra_queue.top();
-    if (curr.tick == (int)grids.size() - 1) {
+    if (curr.tick == (int)grids().size() - 1) {
       safe_path_exists = true;
     }
     dijkstra_queue.pop();
     for (int move_idx = 0; move_idx < (int)moves_3.size(); move_idx++) {
       if (curr.tick >= self.shoes && moves_3[move_idx].size() > 2) break;
       Pos pos = curr.pos;
-      int next_tick = trim_tick(curr.tick + 1);
-      if (do_move(pos, move_idx, curr.tick) && !grids[next_tick].field_at(pos).has_light &&
+      int next_tick = trim_layer(curr.tick + 1);
+      if (do_move(pos, move_idx, curr.tick) && !timeline.has_light(curr.tick + 1, pos) &&
           last_move[next_tick][pos.y][pos.x] == -1) {
         last_move[next_tick][pos.y][pos.x] = move_idx;
         distance[pos.y][pos.x] = min(distance[pos.y][pos.x], curr.tick + 1);
@@ -186,7 +218,7 @@ bool PathFinder::do_move(Pos& pos, int move_idx, int tick) {
   int current_tick = trim_tick(tick);
   for (Direction dir : moves_3[move_idx]) {
     pos += pos_deltas[(int)dir];
-    if (!grids[current_tick].field_at(pos).can_step_here()) {
+    if (!grids()[current_tick].field_at(pos).can_step_here()) {
       return false;
     }
   }
@@ -194,45 +226,54 @@ bool PathFinder::do_move(Pos& pos, int move_idx, int tick) {
 }
 
 void PathFinder::dfs_to_survive(TickPos curr) {
-  if (curr.tick == (int)grids.size() - 1) {
+  if (curr.tick == (int)grids().size() - 1) {
     safe_path_exists = true;
   }
-  if (safe_path_exists) return;
-  int current_tick = trim_tick(curr.tick);
+  if (safe_path_exists || deadline.expired()) return;
+  int current_tick = trim_layer(curr.tick);
   if (dfs_vis[current_tick][curr.pos.y][curr.pos.x]) return;
   dfs_vis[current_tick][curr.pos.y][curr.pos.x] = true;
   for (int move_idx = 0; move_idx < (int)moves_3.size(); move_idx++) {
     if (curr.tick >= self.shoes && moves_3[move_idx].size() > 2) break;
     Pos pos = curr.pos;
-    int next_tick = trim_tick(curr.tick + 1);
-    if (do_move(pos, move_idx, curr.tick) && !grids[next_tick].field_at(pos).has_light) {
+    if (do_move(pos, move_idx, curr.tick) && !timeline.has_light(curr.tick + 1, pos)) {
       dfs_to_survive({curr.tick + 1, pos});
     }
   }
 }
 
-int PathFinder::trim_tick(int tick) const { return tick < (int)grids.size() ? tick : (int)grids.size() - 1; }
+int PathFinder::trim_tick(int tick) const { return tick < (int)grids().size() ? tick : (int)grids().size() - 1; }
+
+int PathFinder::trim_layer(int tick) const { return tick < timeline.length() ? tick : timeline.length() - 1; }
 
 void PathFinder::init_with_grenade_placed(const Grid& starting_grid, const Vampire& self, TickPos at) {
   this->self = self;
-  grids.clear();
-  grids.push_back(starting_grid);
-  if (!grids[0][at.pos].grenades.empty()) {
+  Grid grid_with_grenade = starting_grid;
+  if (!grid_with_grenade[at.pos].grenades.empty()) {
     error("There is already a grenade at the specified location");
   }
-  grids[0][at.pos].grenades.push_back({at.pos, self.id, GRENADE_TICKS, self.range});
-  init_internals(GRENADE_TICKS + 1);
+  grid_with_grenade[at.pos].grenades.push_back({at.pos, self.id, GRENADE_TICKS, self.range});
+  forecast = make_forecast(grid_with_grenade, GRENADE_TICKS + 1);
+  timeline.init(forecast, 0);  // only used for checking survivability
+  init_internals();
 }
 
-void PathFinder::init_internals(int grid_ticks) {
+shared_ptr<const vector<Grid>> PathFinder::make_forecast(const Grid& starting_grid, int grid_ticks) {
+  auto grids = make_shared<vector<Grid>>();
+  grids->reserve(grid_ticks + 1);
+  grids->push_back(starting_grid);
   for (int i = 1; i <= grid_ticks; i++) {
-    grids.emplace_back(grids.back());  // copy the last
-    grids.back().step();
+    grids->emplace_back(grids->back());  // copy the last
+    grids->back().step();
   }
-  int size = grids[0].fields.size();
+  return grids;
+}
+
+void PathFinder::init_internals() {
+  int size = grids()[0].fields.size();
   distance.assign(size, vector<int>(size, INF));
-  last_move.assign(grids.size(), vector<vector<int>>(size, vector<int>(size, -1)));
-  dfs_vis.assign(grids.size(), vector<vector<bool>>(size, vector<bool>(size)));
+  last_move.assign(timeline.length(), vector<vector<int>>(size, vector<int>(size, -1)));
+  dfs_vis.assign(timeline.length(), vector<vector<bool>>(size, vector<bool>(size)));
   dijkstra_queue = priority_queue<QueueEntry>();
   QueueEntry start{0, self.pos, -2, 0};  // move_idx = -2 is important, see below
   dijkstra_queue.push(start);
@@ -9,14 +9,19 @@
 #include "../common/GameState.h"
 #include "../common/Grid.h"
 #include "../common/positions.h"
+#include "Deadline.h"
 #include "SafetyChecker.h"
+#include "Timeline.h"
 
 class PathFinder {
  public:
   static const int INF = 10000;
+  static const int HORIZON = 30;  // ticks the paths are planned for, the forecast grids only cover the grenades
 
-  std::vector<Grid> grids;  // indexed by tick
+  std::shared_ptr<const std::vector<Grid>> forecast;  // indexed by tick, shared by the PathFinders planning on it
+  Timeline timeline;                                  // the forecast extended to HORIZON
   Vampire self;
+  Deadline deadline;  // searches give up (reporting failure) once it expires
 
   void init(const Grid& starting_grid, Vampire self, bool _previous_obj_placed_grenade = false);
   void init_step_safety_checker(const GameState& state);
@@ -27,7 +32,12 @@ class PathFinder {
   std::optional<std::vector<Step>> find_path_to_place_grenade(bool can_throw, Pos target, int min_ticks = 0,
                                                               int max_ticks = 100);
   bool is_survivable();
+  // Whether the moves of path can still be done on this forecast, up to its first grenade step
+  bool is_path_valid(const std::vector<Step>& path);
+  // The first move of a surviving path (staying in place if there is none)
+  Step find_escape_step();
 
+  const std::vector<Grid>& grids() const { return *forecast; }
   int trim_tick(int tick) const;
 
   void print(std::ostream& os);
@@ -65,7 +75,9 @@ class PathFinder {
 
   void dijkstra(Pos target, int min_ticks = 0, int max_ticks = 100);
   void dfs_to_survive(TickPos curr);
-  void init_internals(int grid_ticks);
+  int trim_layer(int tick) const;  // index into the time expanded graph
+  static std::shared_ptr<const std::vector<Grid>> make_forecast(const Grid& starting_grid, int grid_ticks);
+  void init_internals();
   bool do_move(Pos& pos, int move_idx, int tick);
 };
 
@@ -0,0 +1,68 @@
+#include "Ponderer.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "../common/Log.h"
+
+using namespace std;
+
+bool build_forecast(const GameState& state, const InitialData& init_data, const Vampire& self, Grid& grid,
+                    PathFinder& path_finder, const atomic<bool>* cancelled) {
+  grid.init(state, init_data);
+  grid.step();
+  path_finder.init(grid, self);
+  if (cancelled && cancelled->load(memory_order_relaxed)) return false;
+  path_finder.init_step_safety_checker(state);
+  return true;
+}
+
+// Everything the server sends us, in the order it sends it
+string world_of(const GameState& state) {
+  ostringstream world;
+  world << state.tick << ' ' << state.vampire_id << '\n' << state;
+  return world.str();
+}
+
+Ponderer::~Ponderer() {
+  cancelled = true;
+  stop();
+}
+
+void Ponderer::start(const GameState& state, const InitialData& init_data, const Grid& history,
+                     const map<int, Step>& steps) {
+  cancelled = true;
+  stop();
+  Grid next(state, init_data);
+  next.step(steps);
+  predicted = next.get_state();
+  predicted.game_id = state.game_id;
+  predicted.vampire_id = state.vampire_id;
+  // The server does not tell us about invulnerability
+  for (Vampire& vampire : predicted.vampires) vampire.invulnerable = 0;
+  auto self = find_if(predicted.vampires.begin(), predicted.vampires.end(),
+                      [&](const Vampire& vampire) { return vampire.id == state.vampire_id; });
+  if (self == predicted.vampires.end()) return;
+
+  cancelled = false;
+  finished = false;
+  forecast.grid = history;
+  worker = thread([this, init_data, self = *self]() {
+    finished = build_forecast(predicted, init_data, self, forecast.grid, forecast.path_finder, &cancelled);
+  });
+}
+
+optional<Forecast> Ponderer::take(const GameState& state) {
+  if (!worker.joinable()) return nullopt;
+  bool hit = world_of(predicted) == world_of(state);
+  if (!hit) cancelled = true;
+  stop();
+  ++(hit ? hits : misses);
+  LOG(INFO) << "Pondering " << (hit ? "hit" : "missed") << ", " << hits << " of " << hits + misses << " hit so far";
+  if (!hit || !finished) return nullopt;
+  return move(forecast);
+}
+
+void Ponderer::stop() {
+  if (worker.joinable()) worker.join();
+}
@@ -0,0 +1,50 @@
+#ifndef ITECH21_PONDERER_H
+#define ITECH21_PONDERER_H
+
+#include <atomic>
+#include <map>
+#include <optional>
+#include <thread>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "PathFinder.h"
+
+// The part of a tick's preparation that only depends on the received state
+struct Forecast {
+  Grid grid;  // the received state stepped to the next tick without moves
+  PathFinder path_finder;
+};
+
+// grid keeps the history (e.g. powerup protection) of the previous ticks, it is reinitialized from state.
+// Returns false if it was cancelled before finishing.
+bool build_forecast(const GameState& state, const InitialData& init_data, const Vampire& self, Grid& grid,
+                    PathFinder& path_finder, const std::atomic<bool>* cancelled = nullptr);
+
+// Builds the forecast of the next tick in the background while we are waiting for the server, for the state the
+// steps of the vampires lead to. If the server sends another one, the work is thrown away.
+class Ponderer {
+ public:
+  Ponderer() = default;
+  Ponderer(const Ponderer&) = delete;
+  Ponderer& operator=(const Ponderer&) = delete;
+  ~Ponderer();
+
+  // The vampires without a step stay in place
+  void start(const GameState& state, const InitialData& init_data, const Grid& history,
+             const std::map<int, Step>& steps);
+  // Stops pondering and returns the forecast if it was built for exactly this state
+  std::optional<Forecast> take(const GameState& state);
+
+ private:
+  std::thread worker;
+  std::atomic<bool> cancelled{false};
+  GameState predicted;
+  Forecast forecast;
+  bool finished = false;
+  int hits = 0, misses = 0;
+
+  void stop();
+};
+
+#endif  // ITECH21_PONDERER_H
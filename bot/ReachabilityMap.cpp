@@ -0,0 +1,76 @@
+#include "ReachabilityMap.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const int ReachabilityMap::UNREACHABLE;
+
+void ReachabilityMap::init(const Timeline& timeline, const vector<Vampire>& vampires, int max_ticks) {
+  size = timeline.grid(0).fields.size();
+  vampire_ids.clear();
+  // [y * size + x], bit i is set if vampire index i can stand there at the tick
+  vector<uint8_t> present(size * size, 0);
+  arrival_ticks.assign(vampires.size(), vector<int>(size * size, UNREACHABLE));
+  for (const Vampire& vampire : vampires) {
+    present[vampire.pos.y * size + vampire.pos.x] |= 1 << vampire_ids.size();
+    arrival_ticks[vampire_ids.size()][vampire.pos.y * size + vampire.pos.x] = 0;
+    vampire_ids.push_back(vampire.id);
+  }
+
+  for (int tick = 0; tick < max_ticks; ++tick) {
+    const Grid& grid = timeline.grid(tick);
+    uint8_t with_shoes = 0;
+    for (int i = 0; i < (int)vampires.size(); ++i) {
+      if (tick < vampires[i].shoes) with_shoes |= 1 << i;
+    }
+    vector<uint8_t> next(size * size, 0);
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        uint8_t here = present[y * size + x];
+        if (!here) continue;
+        for (const auto& move : moves_3) {
+          uint8_t movers = move.size() > 2 ? here & with_shoes : here;
+          if (!movers) break;
+          Pos pos{y, x};
+          bool valid = true;
+          for (Direction dir : move) {
+            pos += pos_deltas[(int)dir];
+            if (!grid[pos].can_step_here()) {
+              valid = false;
+              break;
+            }
+          }
+          if (valid && !timeline.has_light(tick + 1, pos)) next[pos.y * size + pos.x] |= movers;
+        }
+      }
+    }
+    for (int cell = 0; cell < size * size; ++cell) {
+      for (int i = 0; i < (int)vampire_ids.size(); ++i) {
+        if ((next[cell] >> i & 1) && arrival_ticks[i][cell] == UNREACHABLE) arrival_ticks[i][cell] = tick + 1;
+      }
+    }
+    // Once the fields and the reachable fields stop changing, they stay the same
+    bool settled = timeline.next_change_after(tick + 1) >= max_ticks && next == present;
+    present = move(next);
+    if (settled) break;
+  }
+}
+
+int ReachabilityMap::index_of(int vampire_id) const {
+  auto it = find(vampire_ids.begin(), vampire_ids.end(), vampire_id);
+  return it == vampire_ids.end() ? -1 : (int)(it - vampire_ids.begin());
+}
+
+int ReachabilityMap::arrival(int vampire_id, Pos pos) const {
+  int i = index_of(vampire_id);
+  return i == -1 ? UNREACHABLE : arrival_ticks[i][pos.y * size + pos.x];
+}
+
+int ReachabilityMap::rival_arrival(int vampire_id, Pos pos) const {
+  int result = UNREACHABLE;
+  for (int i = 0; i < (int)vampire_ids.size(); ++i) {
+    if (vampire_ids[i] != vampire_id) result = min(result, arrival_ticks[i][pos.y * size + pos.x]);
+  }
+  return result;
+}
@@ -0,0 +1,34 @@
+#ifndef ITECH21_REACHABILITYMAP_H
+#define ITECH21_REACHABILITYMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "../common/positions.h"
+#include "Timeline.h"
+
+// Where every vampire can be at every tick, computed in one sweep over the time-expanded graph of a forecast.
+// Movement follows the rules of PathFinder: no stepping through obstacles, no standing in light, and moves of length 3
+// only while the vampire has shoes.
+class ReachabilityMap {
+ public:
+  static const int UNREACHABLE = 10000;
+
+  void init(const Timeline& timeline, const std::vector<Vampire>& vampires, int max_ticks = 40);
+
+  // The first tick when the vampire can stand on pos
+  int arrival(int vampire_id, Pos pos) const;
+  // The first tick when any other vampire can stand on pos
+  int rival_arrival(int vampire_id, Pos pos) const;
+
+ private:
+  int size = 0;
+  std::vector<int> vampire_ids;                 // vampire index -> id
+  std::vector<std::vector<int>> arrival_ticks;  // [vampire index][y * size + x]
+
+  int index_of(int vampire_id) const;
+};
+
+#endif  // ITECH21_REACHABILITYMAP_H
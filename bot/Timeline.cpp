@@ -0,0 +1,44 @@
+#include "Timeline.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const int Timeline::NEVER;
+
+void Timeline::init(shared_ptr<const vector<Grid>> _forecast, int length) {
+  forecast = move(_forecast);
+  const Grid& last = forecast->back();
+  int last_tick = (int)forecast->size() - 1;
+  size = last.fields.size();
+  lit_at.assign(size * size, NEVER);
+  ring_start = ring_end = NEVER;
+  // The ring lights its nTh fields when the game tick becomes max_tick + nTh + 1
+  for (int nTh = 0;; ++nTh) {
+    int tick = max(last.max_tick + nTh + 1 - last.tick + last_tick, last_tick + 1);
+    bool lit = Grid::for_ring_fields(size, nTh, [&](const Pos& pos) {
+      lit_at[pos.y * size + pos.x] = min(lit_at[pos.y * size + pos.x], tick);
+    });
+    if (!lit) break;
+    if (nTh == 0) ring_start = tick;
+    ring_end = tick;
+  }
+  // Without the ring everything stays the same after the forecast, the time expanded graph can stop there
+  ticks = ring_start < length ? min(length, ring_end + 1) : 0;
+  ticks = max(ticks, (int)forecast->size());
+}
+
+const Grid& Timeline::grid(int tick) const { return (*forecast)[min(tick, (int)forecast->size() - 1)]; }
+
+bool Timeline::has_light(int tick, Pos pos) const {
+  if (tick < (int)forecast->size()) return (*forecast)[tick][pos].has_light;
+  return tick >= lit_at[pos.y * size + pos.x];
+}
+
+int Timeline::next_change_after(int tick) const {
+  // The last grid may still have the light of exploding grenades
+  if (tick < (int)forecast->size()) return tick + 1;
+  if (tick + 1 < ring_start) return ring_start;
+  if (tick + 1 <= ring_end) return tick + 1;
+  return NEVER;
+}
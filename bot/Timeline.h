@@ -0,0 +1,34 @@
+#ifndef ITECH21_TIMELINE_H
+#define ITECH21_TIMELINE_H
+
+#include <memory>
+#include <vector>
+
+#include "../common/Grid.h"
+#include "../common/positions.h"
+
+// The forecast extended far beyond the grenades without copying more grids. After the last forecast grid no grenade
+// is left to explode (nobody moves in the forecast), so the only change is the closing ring of lights at the end of
+// the game. A ring field never goes dark again, so one tick per field is enough to describe it.
+class Timeline {
+ public:
+  static const int NEVER = 1000000;
+
+  void init(std::shared_ptr<const std::vector<Grid>> forecast, int length);
+
+  // The ticks worth planning for, at most the requested length. Nothing changes after them.
+  int length() const { return ticks; }
+  const Grid& grid(int tick) const;  // the forecast grid, the last one after the forecast
+  bool has_light(int tick, Pos pos) const;
+  // The first tick after tick when the light changes anywhere, NEVER if it stays the same
+  int next_change_after(int tick) const;
+
+ private:
+  std::shared_ptr<const std::vector<Grid>> forecast;
+  int ticks = 0;
+  int size = 0;
+  std::vector<int> lit_at;  // [y * size + x], the first tick after the forecast when the ring lights the field
+  int ring_start = NEVER, ring_end = NEVER;
+};
+
+#endif  // ITECH21_TIMELINE_H
@@ -0,0 +1,35 @@
+// Plays games of a map in process, without the server and the bot processes, see Arena. Each game uses the next seed
+// of the server's random generator, the scores are printed like scores.json.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../common/Log.h"
+#include "Arena.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    cerr << "usage: arena_sim <map> [games] [first seed] [think ms]" << endl;
+    return 1;
+  }
+  Arena arena(argv[1]);
+  int games = argc > 2 ? stoi(argv[2]) : 1;
+  int first_seed = argc > 3 ? stoi(argv[3]) : 0;
+  chrono::milliseconds think_time(argc > 4 ? stoi(argv[4]) : 0);
+
+  auto start = chrono::steady_clock::now();
+  for (int seed = first_seed; seed < first_seed + games; ++seed) {
+    Log::set_level(LogLevel::NONE);  // the AIs are talkative
+    vector<double> scores = arena.play(seed, think_time);
+    Log::set_level(LogLevel::DEBUG);
+    cout << seed << ": [";
+    for (size_t i = 0; i < scores.size(); ++i) cout << (i ? ", " : "") << scores[i];
+    cout << "]" << endl;
+  }
+  chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+  cerr << games << " games in " << seconds.count() << " seconds, " << games * 60 / seconds.count()
+       << " games per minute" << endl;
+}
@@ -1,9 +1,15 @@
 #ifndef CONSOLE_CONNECTOR_H_INCLUDED
 #define CONSOLE_CONNECTOR_H_INCLUDED
 
-#include <cstring>
 #include <iostream>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
 #include "connector.h"
 
 class console_connector final : public connector {
@@ -18,17 +24,17 @@ class console_connector final : public connector {
     return std::cout ? size : 0;
   }
 
+  // Reads what is available from stdin, up to size bytes, past std::cin
   virtual std::streamsize recv(char* buffer, std::streamsize size) override {
-    std::memset(buffer, 0, size);
-    auto res = std::cin.getline(buffer, size).gcount();
-    if (std::cin.fail() && !std::cin.eof()) {
-      res = size - 1;
-      std::cin.clear();
-    }
-    if (res > 0 && buffer[res - 1] == '\0') {
-      buffer[res - 1] = '\n';
-    }
-    return res;
+#ifdef _WIN32
+    return _read(0, buffer, static_cast<unsigned>(size));
+#else
+    std::streamsize received;
+    do {
+      received = read(0, buffer, size);
+    } while (received < 0 && errno == EINTR);
+    return received;
+#endif
   }
 };
 
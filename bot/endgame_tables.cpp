@@ -0,0 +1,99 @@
+// Precomputes the EndgameSolver values of the ring stages of maps, the bot loads them from endgame.tbl.
+// The positions are solved with both vampires on any free field with any health, like the first vampire of the map
+// or after collecting powerups otherwise, and without bats or grenades on the map.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "EndgameSolver.h"
+
+using namespace std;
+
+vector<string> read_message(istream& in) {
+  vector<string> lines;
+  string line;
+  while (getline(in, line) && line != ".") lines.push_back(line);
+  return lines;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    cerr << "usage: endgame_tables <table> <map1> ... <mapN>" << endl;
+    return 1;
+  }
+  EndgameSolver solver;
+  ifstream existing(argv[1]);
+  solver.load(existing);
+  existing.close();
+
+  for (int i = 2; i < argc; ++i) {
+    ifstream map_file(argv[i]);
+    InitialData init_data(read_message(map_file));
+    GameState map_state(read_message(map_file));
+    if (map_state.vampires.size() < 2) {
+      cerr << argv[i] << ": not enough vampires" << endl;
+      continue;
+    }
+    Vampire model = map_state.vampires[0];
+    // The stats at the start and after collecting powerups: a range that reaches every field and as many grenades as
+    // make a difference (greater stats share their key, see EndgameSolver::key_of). In between, the grenades of the
+    // two vampires are the same, as they have usually collected about as many powerups.
+    auto powered_up = [&model, &init_data](int grenades) {
+      Vampire vampire = model;
+      vampire.grenades = grenades;
+      vampire.range = init_data.size;
+      return vampire;
+    };
+    vector<pair<Vampire, Vampire>> stats;  // self, opponent
+    for (const Vampire& self : {model, powered_up(GRENADE_TICKS + 1)}) {
+      for (const Vampire& opponent : {model, powered_up(GRENADE_TICKS + 1)}) stats.emplace_back(self, opponent);
+    }
+    for (int grenades = model.grenades + 1; grenades <= GRENADE_TICKS; ++grenades) {
+      stats.emplace_back(powered_up(grenades), powered_up(grenades));
+    }
+
+    GameState state;
+    for (state.tick = init_data.max_tick + 1;; ++state.tick) {
+      state.vampires = {model, model};
+      state.vampires[1].id = model.id + 1;
+      Grid stage(state, init_data);
+      if (!EndgameSolver::applies(stage)) continue;
+      // The fields the ring hasn't reached in this stage
+      vector<Pos> free_fields;
+      Grid next{stage};
+      next.step();
+      for (int y = 0; y < init_data.size; ++y) {
+        for (int x = 0; x < init_data.size; ++x) {
+          if (next.fields[y][x].can_step_here() && !next.fields[y][x].has_light) free_fields.push_back({y, x});
+        }
+      }
+      if (free_fields.empty()) break;
+
+      size_t solved_before = solver.size();
+      for (const Pos& self_pos : free_fields) {
+        for (const Pos& opponent_pos : free_fields) {
+          for (auto [self, opponent] : stats) {
+            for (self.health = 1; self.health <= model.health; ++self.health) {
+              for (opponent.health = 1; opponent.health <= model.health; ++opponent.health) {
+                self.pos = self_pos;
+                opponent.id = model.id + 1;
+                opponent.pos = opponent_pos;
+                state.vampires = {self, opponent};
+                solver.solve(Grid(state, init_data), self.id);
+              }
+            }
+          }
+        }
+      }
+      cerr << argv[i] << ": tick " << state.tick << ", " << free_fields.size() << " free fields, "
+           << solver.size() - solved_before << " new states" << endl;
+    }
+  }
+
+  ofstream table(argv[1]);
+  solver.save(table);
+}
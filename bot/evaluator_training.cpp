@@ -0,0 +1,100 @@
+// Fits the Evaluator to self-play games: every vampire of the map is played by an AI without time limit, and the
+// features of each vampire's position are paired with the points it collects in the next label_ticks ticks. The
+// games differ in the seed of the server's random generator. The bot loads the weights from evaluator.weights.
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "../common/Log.h"
+#include "AI.h"
+#include "Evaluator.h"
+
+using namespace std;
+
+const int label_ticks = 20;
+const int epochs = 30;
+const float learning_rate = 0.001f;
+
+vector<string> read_message(istream& in) {
+  vector<string> lines;
+  string line;
+  while (getline(in, line) && line != ".") lines.push_back(line);
+  return lines;
+}
+
+double total_score(const Grid& grid, int vampire_id) {
+  double total = 0;
+  for (const auto& scores : grid.scores) {
+    auto it = scores.find(vampire_id);
+    if (it != scores.end()) total += it->second;
+  }
+  return total;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    cerr << "usage: evaluator_training <weights> <games> <map1> ... <mapN>" << endl;
+    return 1;
+  }
+  int games = stoi(argv[2]);
+  vector<pair<Evaluator::Features, float>> samples;
+
+  for (int i = 3; i < argc; ++i) {
+    for (int seed = 0; seed < games; ++seed) {
+      ifstream map_file(argv[i]);
+      InitialData init_data(read_message(map_file));
+      GameState map_state(read_message(map_file));
+      Grid grid(seed, true /* server */);
+      grid.init(map_state, init_data);
+
+      vector<unique_ptr<AI>> ais;
+      for (size_t j = 0; j < map_state.vampires.size(); ++j) {
+        ais.push_back(make_unique<AI>());
+        ais.back()->initial_data = init_data;
+      }
+      // The samples waiting for their label, with the score of the vampire when they were taken
+      map<int, vector<pair<Evaluator::Features, double>>> pending;
+      Log::set_level(LogLevel::NONE);  // the AIs are talkative
+      while (grid.tick < init_data.max_tick && grid.get_state().vampires.size() > 1) {
+        GameState state = grid.get_state();
+        map<int, Step> steps;
+        for (size_t j = 0; j < map_state.vampires.size(); ++j) {
+          int vampire_id = map_state.vampires[j].id;
+          if (!grid.get_vampire(vampire_id).has_value()) continue;
+          ais[j]->set_state(state.request_for(init_data.game_id, vampire_id));
+          pending[vampire_id].emplace_back(Evaluator::features(*ais[j], ais[j]->self.pos),
+                                           total_score(grid, vampire_id));
+          steps[vampire_id] = ais[j]->get_step();
+        }
+        grid.step(steps);
+        for (auto& [vampire_id, vampire_samples] : pending) {
+          if ((int)vampire_samples.size() < label_ticks) continue;
+          const auto& [features, score] = vampire_samples[vampire_samples.size() - label_ticks];
+          samples.emplace_back(features, (float)(total_score(grid, vampire_id) - score));
+        }
+      }
+      Log::set_level(LogLevel::DEBUG);
+      cerr << argv[i] << ": game " << seed + 1 << "/" << games << ", " << samples.size() << " samples" << endl;
+    }
+  }
+
+  Evaluator evaluator;
+  evaluator.randomize(0);
+  auto mean_error = [&]() {
+    double sum = 0;
+    for (const auto& [features, label] : samples) sum += abs(evaluator.evaluate(features) - label);
+    return sum / max<size_t>(samples.size(), 1);
+  };
+  cerr << "Mean error before training: " << mean_error() << endl;
+  evaluator.train(samples, epochs, learning_rate);
+  cerr << "Mean error after training: " << mean_error() << endl;
+
+  ofstream out(argv[1]);
+  evaluator.save(out);
+}
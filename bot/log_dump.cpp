@@ -0,0 +1,17 @@
+// Prints a binary log of the bot as text, see Log::open.
+
+#include <fstream>
+#include <iostream>
+
+#include "../common/Log.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    cerr << "usage: log_dump <log>" << endl;
+    return 1;
+  }
+  ifstream in(argv[1], ios::binary);
+  Log::dump(in, cout);
+}
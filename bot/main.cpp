@@ -1,30 +1,51 @@
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <cstdint>
 #include <ctime>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "../common/BinaryCodec.h"
+#include "../common/Log.h"
+#include "Deadline.h"
 #include "console_connector.h"
+#include "message_reader.h"
+#ifdef __linux__
+#include "shm_connector.h"
+#endif
 #include "socket_connector.h"
 #include "solver.h"
 
 class client {
+  // Part of the process timeout the solver may spend thinking, the rest is reserved for parsing and sending
+  static constexpr double think_ratio = 0.75;
+
   std::unique_ptr<connector> _connector;
   std::chrono::duration<double> process_timeout_s;
   bool only_logout;
-  std::string remained_buffer;
+  bool binary_protocol;
+  bool delta_states;
+  GameState delta_state;  // the state the deltas are applied to
+  uint32_t delta_sequence = 0;
+  message_reader reader;
   solver your_solver;
 
  public:
-  client(std::unique_ptr<connector> conn, int process_timeout_ms, bool logout, const char token[], int level)
-      : _connector(std::move(conn)), process_timeout_s(process_timeout_ms / 1000.), only_logout(logout) {
+  client(std::unique_ptr<connector> conn, int process_timeout_ms, bool logout, const char token[], int level,
+         bool binary, bool delta)
+      : _connector(std::move(conn)),
+        process_timeout_s(process_timeout_ms / 1000.),
+        only_logout(logout),
+        binary_protocol((binary || delta) && !logout),
+        delta_states(delta && !logout) {
     if (!_connector->is_valid()) {
-      std::cerr << "[main] "
-                << "Not a valid connector" << std::endl;
+      LOG(WARN) << "[main] "
+                << "Not a valid connector";
       return;
     }
 
@@ -38,6 +59,13 @@ class client {
       if (level) {
         str += " " + std::to_string(level);
       }
+      if (delta_states) {
+        str += " ";
+        str += binary::delta_login_token;
+      } else if (binary_protocol) {
+        str += " ";
+        str += binary::login_token;
+      }
       login_messages.push_back(str);
     }
 
@@ -52,111 +80,108 @@ class client {
     }
     message += ".\n";
 
+    send_raw(message);
+  }
+
+  void send_raw(const std::string& message) {
     auto sent_bytes = _connector->send(message.c_str(), message.size());
 
     if (sent_bytes != static_cast<std::streamsize>(message.size())) {
-      std::cerr << "[main] "
-                << "Warning: Cannot sent message properly: " << message << std::endl;
-      std::cerr << "[main] " << sent_bytes << " byte sent from " << message.size() << ". Closing connection."
-                << std::endl;
+      LOG(WARN) << "[main] "
+                << "Warning: Cannot sent message properly: " << message;
+      LOG(WARN) << "[main] " << sent_bytes << " byte sent from " << message.size() << ". Closing connection.";
       _connector->invalidate();
     }
   }
 
-  std::vector<std::string> receive_message() {
-    std::vector<std::string> result;
-
-    std::string curr_buffer;
-    std::swap(curr_buffer, remained_buffer);
-    while (true) {
-      std::string line;
-      std::stringstream consumer(curr_buffer);
-      while (std::getline(consumer, line)) {
-        if (line == ".") {
-          if (!consumer.eof()) {
-            remained_buffer = consumer.str().substr(consumer.tellg());
-          }
-          return result;
-        } else if (!line.empty()) {
-          result.push_back(line);
-        }
+  // The payload is valid until the next call, false when the connection is closed
+  bool receive_frame(binary::FrameType& type, std::string_view& payload) {
+    while (!reader.next_frame(type, payload)) {
+      auto received_bytes = reader.receive(*_connector);
+      if (received_bytes > 0) continue;
+
+      if (received_bytes < 0) {
+        LOG(ERR) << "[main] "
+                 << "Error: recv failed!";
       }
+      LOG(INFO) << "[main] "
+                << "Connection closed.";
+      _connector->invalidate();
+      return false;
+    }
+    return true;
+  }
 
-      char array_buffer[512];
-
-      auto received_bytes = _connector->recv(array_buffer, 511);
-
-      switch (received_bytes) {
-        case -1:
-          std::cerr << "[main] "
-                    << "Error: recv failed!" << std::endl;
-          [[fallthrough]];
-        case 0:
-          std::cerr << "[main] "
-                    << "Connection closed." << std::endl;
-          _connector->invalidate();
-          if (!result.empty()) {
-            std::cerr << "[main] "
-                      << "Latest message processing ..." << std::endl;
-          }
-          return result;
-      }
-      array_buffer[received_bytes] = '\0';
-      if (!curr_buffer.empty() && curr_buffer.back() != '\n') {
-        curr_buffer = result.back();
-        result.pop_back();
-      } else {
-        curr_buffer.clear();
+  // The lines are valid until the next call
+  std::vector<std::string_view> receive_message() {
+    std::vector<std::string_view> result;
+    while (!reader.next_message(result)) {
+      auto received_bytes = reader.receive(*_connector);
+      if (received_bytes > 0) continue;
+
+      if (received_bytes < 0) {
+        LOG(ERR) << "[main] "
+                 << "Error: recv failed!";
       }
-      curr_buffer += array_buffer;
+      LOG(INFO) << "[main] "
+                << "Connection closed.";
+      _connector->invalidate();
+      reader.rest(result);
+      if (!result.empty()) {
+        LOG(INFO) << "[main] "
+                  << "Latest message processing ...";
+      }
+      break;
     }
+    return result;
   }
 
  public:
   void run() {
+    if (binary_protocol) return run_binary();
     bool firstTime = true;
     while (_connector->is_valid()) {
       auto measure_start = std::chrono::steady_clock::now();
 
-      std::vector<std::string> tmp = receive_message();
+      std::vector<std::string_view> message = receive_message();
 
       std::chrono::duration<double> read_seconds = std::chrono::steady_clock::now() - measure_start;
       if (read_seconds > process_timeout_s * 2) {
-        std::cerr << "[main] "
-                  << "Read took: " << read_seconds.count() << " seconds (>" << (process_timeout_s * 2).count() << "s)"
-                  << std::endl;
+        LOG(WARN) << "[main] "
+                  << "Read took: " << read_seconds.count() << " seconds (>" << (process_timeout_s * 2).count() << "s)";
       }
 
       if (only_logout) {
-        for (auto&& s : tmp) {
-          std::cerr << s << std::endl;
+        for (auto&& s : message) {
+          LOG(INFO) << s;
         }
         return;
       }
 
-      if (tmp.empty()) {
+      if (message.empty()) {
         continue;
       }
 
       std::clock_t measure_clock_start = std::clock();
       measure_start = std::chrono::steady_clock::now();
 
+      std::vector<std::string> tmp;
       if (firstTime) {
-        your_solver.startMessage(tmp);
-        tmp.clear();
+        your_solver.startMessage(message);
         firstTime = false;
-      } else
-        tmp = your_solver.processTick(tmp);
+      } else {
+        Deadline deadline{measure_start +
+                          std::chrono::duration_cast<Deadline::clock::duration>(process_timeout_s * think_ratio)};
+        tmp = your_solver.processTick(message, deadline);
+      }
 
       std::chrono::duration<double> process_seconds = std::chrono::steady_clock::now() - measure_start;
-      std::cerr << "Process took: " << process_seconds.count() << " seconds" << std::endl;
+      LOG(INFO) << "Process took: " << process_seconds.count() << " seconds";
       if (process_seconds > process_timeout_s) {
-        std::cerr << "[main] "
-                  << "Process took: " << process_seconds.count() << " seconds (>" << process_timeout_s.count() << "s)"
-                  << std::endl;
-        std::cerr << "[main] "
-                  << "CPU time used: " << static_cast<double>(std::clock() - measure_clock_start) / CLOCKS_PER_SEC
-                  << std::endl;
+        LOG(WARN) << "[main] "
+                  << "Process took: " << process_seconds.count() << " seconds (>" << process_timeout_s.count() << "s)";
+        LOG(WARN) << "[main] "
+                  << "CPU time used: " << static_cast<double>(std::clock() - measure_clock_start) / CLOCKS_PER_SEC;
       }
 
       if (!_connector->is_valid() || tmp.empty()) {
@@ -164,23 +189,96 @@ class client {
       }
 
       send_messages(tmp);
+      your_solver.ponder();
 
       std::chrono::duration<double> process_with_send_seconds = std::chrono::steady_clock::now() - measure_start;
       if (process_seconds > process_timeout_s) {
-        std::cerr << "[main] "
+        LOG(WARN) << "[main] "
                   << "Process with send took: " << process_with_send_seconds.count() << " seconds (>"
-                  << process_timeout_s.count() << "s)" << std::endl;
-        std::cerr << "[main] "
+                  << process_timeout_s.count() << "s)";
+        LOG(WARN) << "[main] "
                   << "CPU time used: " << static_cast<double>(std::clock() - measure_clock_start) / CLOCKS_PER_SEC
-                  << " sec" << std::endl;
+                  << " sec";
       }
     }
-    std::cerr << "[main] "
-              << "Game over" << std::endl;
+    LOG(INFO) << "[main] "
+              << "Game over";
+  }
+
+  // The same loop for the binary protocol, the frames are decoded straight into the solver's types
+  void run_binary() {
+    std::string response;
+    binary::FrameType type;
+    std::string_view payload;
+    while (receive_frame(type, payload)) {
+      auto measure_start = std::chrono::steady_clock::now();
+      if (type == binary::FrameType::INITIAL_DATA) {
+        your_solver.start(binary::decode_initial_data(payload));
+        continue;
+      }
+      if (type == binary::FrameType::WRONG) {
+        LOG(WARN) << "[main] "
+                  << "WRONG " << payload;
+        continue;
+      }
+      GameState state;
+      if (type == binary::FrameType::REQUEST) {
+        state = binary::decode_state(payload);
+      } else if (type == binary::FrameType::DELTA) {
+        if (!binary::apply_delta(payload, delta_state, delta_sequence)) {
+          LOG(WARN) << "[main] "
+                    << "Delta can't be applied, asking for a keyframe";
+          response.clear();
+          binary::encode_resync(response, delta_state.game_id, delta_state.tick, delta_state.vampire_id);
+          send_raw(response);
+          continue;
+        }
+        state = delta_state;
+      } else {
+        LOG(WARN) << "[main] "
+                  << "Unexpected frame type " << static_cast<int>(type);
+        continue;
+      }
+
+      Deadline deadline{measure_start +
+                        std::chrono::duration_cast<Deadline::clock::duration>(process_timeout_s * think_ratio)};
+      binary::Response answer{state.game_id, state.tick, state.vampire_id, {}};
+      answer.step = your_solver.step(std::move(state), deadline);
+      response.clear();
+      binary::encode(response, answer);
+
+      std::chrono::duration<double> process_seconds = std::chrono::steady_clock::now() - measure_start;
+      LOG(INFO) << "Process took: " << process_seconds.count() << " seconds";
+      if (process_seconds > process_timeout_s) {
+        LOG(WARN) << "[main] "
+                  << "Process took: " << process_seconds.count() << " seconds (>" << process_timeout_s.count() << "s)";
+      }
+
+      send_raw(response);
+      your_solver.ponder();
+    }
+    LOG(INFO) << "[main] "
+              << "Game over";
   }
 };
 
 int main(int argc, char** argv) {
+  // The options are taken out, the rest of the arguments are positional
+  bool binary = false, delta = false, shm = false;
+  int positional = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (0 == std::strcmp("--binary", argv[i])) {
+      binary = true;
+    } else if (0 == std::strcmp("--delta", argv[i])) {
+      delta = true;
+    } else if (0 == std::strcmp("--shm", argv[i])) {
+      shm = true;
+    } else {
+      argv[positional++] = argv[i];
+    }
+  }
+  argc = positional;
+
   if (argc > 1 && 0 == std::strcmp("help", argv[1])) {
     std::cerr << "Usage: " << std::endl
               << argv[0] << " help                   "
@@ -191,10 +289,18 @@ int main(int argc, char** argv) {
               << "\tPlay with [level] level, use tcp connection to communicate. " << std::endl
               << argv[0] << " [level] console        "
               << "\tPlay with [level] level, use console stdin and stdout to communicate" << std::endl
-              << " Default level is 0 (which means random 1-10)" << std::endl;
+              << " --binary anywhere asks the server for the binary protocol, --delta for it with delta encoded states"
+              << std::endl
+              << " --shm talks to a server started with --shm through shared memory instead of the console, Linux only"
+              << std::endl
+              << " Default level is 0 (which means random 1-10)" << std::endl
+              << " The log goes to stderr, or in binary to the file in the ITECH21_LOG_FILE environment variable"
+              << std::endl;
     return 0;
   }
 
+  if (const char* log_file = std::getenv("ITECH21_LOG_FILE")) Log::open(log_file, Log::Format::BINARY);
+
   const bool logout = argc > 1 && 0 == std::strcmp("logout", argv[1]);
   const int level = argc > 1 && argv[1][0] ? std::atoi(argv[1]) : 0;
   const bool from_console =
@@ -206,12 +312,21 @@ int main(int argc, char** argv) {
   const char token[] = "14XHV8dmN";
 
   try {
-    client(from_console ? std::unique_ptr<connector>(std::make_unique<console_connector>())
-                        : std::make_unique<socket_connector>(host_name, port),
-           from_console ? 200 : 2000, logout, token, level)
-        .run();
+    std::unique_ptr<connector> conn;
+    if (shm) {
+#ifdef __linux__
+      conn = std::make_unique<shm_connector>();
+#else
+      throw std::runtime_error("Shared memory is only supported on Linux");
+#endif
+    } else if (from_console) {
+      conn = std::make_unique<console_connector>();
+    } else {
+      conn = std::make_unique<socket_connector>(host_name, port);
+    }
+    client(std::move(conn), from_console || shm ? 200 : 2000, logout, token, level, binary, delta).run();
   } catch (std::exception& e) {
-    std::cerr << "[main] "
-              << "Exception throwed. what(): " << e.what() << std::endl;
+    LOG(ERR) << "[main] "
+             << "Exception throwed. what(): " << e.what();
   }
 }
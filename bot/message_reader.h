@@ -0,0 +1,85 @@
+#ifndef MESSAGE_READER_H_INCLUDED
+#define MESSAGE_READER_H_INCLUDED
+
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../common/BinaryCodec.h"
+#include "connector.h"
+
+// Splits what the connector receives into messages ending with a "." line. Every byte is scanned once: the lines
+// found so far are kept as offsets, and the buffer is only compacted to its front when it is full, so the lines of a
+// message stay contiguous. The lines handed out are valid until the next receive. With the binary protocol the same
+// buffer is split into frames instead.
+class message_reader {
+  static constexpr std::size_t block_size = 1 << 16;
+
+  std::vector<char> buffer = std::vector<char>(2 * block_size);
+  std::size_t begin = 0;    // of the message being read
+  std::size_t scanned = 0;  // up to here the bytes are split into lines
+  std::size_t end = 0;      // of the bytes received
+  std::vector<std::pair<std::size_t, std::size_t>> line_offsets;  // from begin, without the empty lines
+
+  void add_line(std::size_t line_begin, std::size_t line_end) {
+    if (line_end > line_begin) line_offsets.emplace_back(line_begin - begin, line_end - line_begin);
+  }
+
+  void take_lines(std::vector<std::string_view>& lines) {
+    lines.clear();
+    for (auto [offset, length] : line_offsets) lines.emplace_back(buffer.data() + begin + offset, length);
+    line_offsets.clear();
+  }
+
+ public:
+  // Splits off the next message if it has arrived, without its "." line
+  bool next_message(std::vector<std::string_view>& lines) {
+    while (scanned < end) {
+      auto* newline = static_cast<const char*>(std::memchr(buffer.data() + scanned, '\n', end - scanned));
+      if (!newline) return false;
+      std::size_t line_begin = scanned, line_end = newline - buffer.data();
+      scanned = line_end + 1;
+      if (line_end - line_begin == 1 && buffer[line_begin] == '.') {
+        take_lines(lines);
+        begin = scanned;
+        return true;
+      }
+      add_line(line_begin, line_end);
+    }
+    return false;
+  }
+
+  // Splits off the next frame if it has arrived
+  bool next_frame(binary::FrameType& type, std::string_view& payload) {
+    std::string_view data(buffer.data() + begin, end - begin);
+    if (!binary::split_frame(data, type, payload)) return false;
+    begin = scanned = end - data.size();
+    return true;
+  }
+
+  // The lines of the unfinished message, when no more bytes come
+  void rest(std::vector<std::string_view>& lines) {
+    add_line(scanned, end);
+    take_lines(lines);
+    begin = scanned = end;
+  }
+
+  // Reads a block from the connector, returns the result of its recv
+  std::streamsize receive(connector& conn) {
+    if (buffer.size() - end < block_size) {
+      if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        scanned -= begin;
+        end -= begin;
+        begin = 0;
+      }
+      if (buffer.size() - end < block_size) buffer.resize(end + block_size);
+    }
+    std::streamsize received = conn.recv(buffer.data() + end, block_size);
+    if (received > 0) end += received;
+    return received;
+  }
+};
+
+#endif  // MESSAGE_READER_H_INCLUDED
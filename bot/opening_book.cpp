@@ -0,0 +1,72 @@
+// Builds the opening book from self-play: every vampire of the map is played by an AI without time limit, and the
+// steps of the first book_ticks ticks are recorded. The games differ in the seed of the server's random generator.
+// The bot loads the book from opening.book.
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "../common/Log.h"
+#include "AI.h"
+#include "OpeningBook.h"
+
+using namespace std;
+
+const int book_ticks = 20;
+
+vector<string> read_message(istream& in) {
+  vector<string> lines;
+  string line;
+  while (getline(in, line) && line != ".") lines.push_back(line);
+  return lines;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    cerr << "usage: opening_book <book> <games> <map1> ... <mapN>" << endl;
+    return 1;
+  }
+  OpeningBook book;
+  int games = stoi(argv[2]);
+
+  for (int i = 3; i < argc; ++i) {
+    for (int seed = 0; seed < games; ++seed) {
+      ifstream map_file(argv[i]);
+      InitialData init_data(read_message(map_file));
+      GameState map_state(read_message(map_file));
+      Grid grid(seed, true /* server */);
+      grid.init(map_state, init_data);
+
+      vector<unique_ptr<AI>> ais;
+      for (size_t j = 0; j < map_state.vampires.size(); ++j) {
+        ais.push_back(make_unique<AI>());
+        ais.back()->initial_data = init_data;
+      }
+      Log::set_level(LogLevel::NONE);  // the AIs are talkative
+      for (int tick = 0; tick < book_ticks; ++tick) {
+        GameState state = grid.get_state();
+        map<int, Step> steps;
+        for (size_t j = 0; j < map_state.vampires.size(); ++j) {
+          int vampire_id = map_state.vampires[j].id;
+          if (!grid.get_vampire(vampire_id).has_value()) continue;
+          GameState request = state.request_for(init_data.game_id, vampire_id);
+          ais[j]->set_state(GameState{request});
+          Step step = ais[j]->get_step();
+          book.add(request, init_data.size, step);
+          // Symmetric states have several canonical steps, play the one the bot will read from the book
+          steps[vampire_id] = book.lookup(request, init_data.size).value();
+        }
+        grid.step(steps);
+      }
+      Log::set_level(LogLevel::DEBUG);
+      cerr << argv[i] << ": game " << seed + 1 << "/" << games << ", " << book.size() << " positions" << endl;
+    }
+  }
+
+  ofstream out(argv[1]);
+  book.save(out);
+}
@@ -0,0 +1,49 @@
+// Trains the opponent model from the player*.in.log files the server writes, the bot loads it from opponent.model.
+// The states a player got are replayed the way AI::set_state sees them, so the features match the ones of the game.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "OpponentModel.h"
+
+using namespace std;
+
+vector<string> read_message(istream& in) {
+  vector<string> lines;
+  string line;
+  while (getline(in, line) && line != ".") lines.push_back(line);
+  return lines;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    cerr << "usage: opponent_model <model> <player.in.log1> ... <player.in.logN>" << endl;
+    return 1;
+  }
+  OpponentModel model;
+  {
+    ifstream previous(argv[1]);
+    model.load(previous);
+  }
+
+  for (int i = 2; i < argc; ++i) {
+    ifstream log(argv[i]);
+    InitialData init_data(read_message(log));
+    int states = 0;
+    for (auto lines = read_message(log); !lines.empty(); lines = read_message(log)) {
+      GameState state(lines);
+      Grid grid(state, init_data);
+      grid.step();
+      model.observe(grid, state.vampire_id);
+      ++states;
+    }
+    cerr << argv[i] << ": " << states << " states" << endl;
+  }
+
+  ofstream out(argv[1]);
+  model.save(out);
+}
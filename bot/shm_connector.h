@@ -0,0 +1,60 @@
+#ifndef SHM_CONNECTOR_H_INCLUDED
+#define SHM_CONNECTOR_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "../common/SharedTransport.h"
+#include "connector.h"
+
+// Talks to a server started with --shm on the same host, through the shared memory it names in the environment
+class shm_connector final : public connector {
+  std::unique_ptr<SharedTransport> transport;
+  SharedTransport::Channel* channel = nullptr;
+
+ public:
+  shm_connector() {
+    const char* name = std::getenv(SharedTransport::name_variable);
+    const char* player = std::getenv(SharedTransport::player_variable);
+    if (!name || !player) {
+      invalidate();
+      throw std::runtime_error("Error: No shared memory in the environment, is the server started with --shm?");
+    }
+    transport = SharedTransport::open(name);
+    channel = &transport->channel(std::atoi(player));
+    channel->bot_pid = getpid();
+  }
+
+  virtual ~shm_connector() {
+    if (!channel) return;
+    channel->to_server.closed = true;
+    transport->server_doorbell().ring();
+  }
+
+  virtual std::streamsize send(const char* data, std::streamsize size) override {
+    if (!channel->to_server.write({data, static_cast<std::size_t>(size)}, transport->server_pid())) return 0;
+    transport->server_doorbell().ring();
+    return size;
+  }
+
+  // Waits until something arrives, 0 when the server has closed the channel or is gone
+  virtual std::streamsize recv(char* buffer, std::streamsize size) override {
+    while (true) {
+      std::uint32_t seen = channel->bot_doorbell.rings.load();
+      bool closed = channel->to_bot.closed;  // before reading, so the last write is not missed
+      if (std::size_t count = channel->to_bot.read(buffer, size)) return count;
+      if (closed) return 0;
+      channel->bot_doorbell.wait(seen, std::chrono::steady_clock::now() + SharedTransport::liveness_interval);
+      // Nothing has come for a while, the server may be gone without closing
+      if (channel->bot_doorbell.rings.load() == seen && !SharedTransport::alive(transport->server_pid())) return 0;
+    }
+  }
+};
+
+#endif  // SHM_CONNECTOR_H_INCLUDED
@@ -1,42 +1,60 @@
 #include "solver.h"
 
 #include <algorithm>
-#include <iostream>
 #include <utility>
 
 #include "../common/GameState.h"
+#include "../common/Log.h"
 
 using namespace std;
 
-void solver::startMessage(const vector<string>& startInfos) {
-  for (const auto& line : startInfos) {
-    cerr << line << endl;
-  }
-  ai.initial_data = InitialData(startInfos);
+// Logs a message, one line per element
+template <typename Line>
+auto lines_of(const vector<Line>& message) {
+  return [&message](ostream& os) {
+    for (size_t i = 0; i < message.size(); ++i) os << (i ? "\n" : "") << message[i];
+  };
 }
 
-vector<string> solver::processTick(const vector<string>& infos) {
-  for (const auto& line : infos) {
-    cerr << line << endl;
-  }
+void solver::startMessage(const vector<string_view>& startInfos) {
+  LOG(INFO) << lines_of(startInfos);
+  start(InitialData(startInfos));
+}
+
+void solver::start(InitialData initial_data) {
+  ai.initial_data = move(initial_data);
+  // A large endgame table would make us miss the first ticks
+  ai.load_tables(true);
+}
 
-  vector<string> commands{infos[0]};
+Step solver::step(GameState&& state, const Deadline& deadline) {
+  last_state = state;
+  ai.set_state(move(state));
+  LOG(DEBUG) << [this](ostream& os) { ai.grid.print(os); };
+  LOG(DEBUG) << [this](ostream& os) { ai.score_calculator.print(os); };
+  last_step = ai.get_step(deadline);
+  return last_step;
+}
+
+vector<string> solver::processTick(const vector<string_view>& infos, const Deadline& deadline) {
+  LOG(DEBUG) << lines_of(infos);
+
+  vector<string> commands{string(infos[0])};
   commands[0][2] = 'S';
 
   GameState state(infos);
+  last_state.end = state.end;
   if (!state.end) {
-    Grid(state, ai.initial_data).print(cerr);
-    ai.set_state(move(state));
-    ai.score_calculator.print(cerr);
-    commands.push_back(ai.get_step().to_string());
+    commands.push_back(step(move(state), deadline).to_string());
 
     // ai.path_finder.print(cerr);
 
-    for (const auto& line : commands) {
-      cerr << line << endl;
-    }
-    cerr << endl;
+    LOG(DEBUG) << lines_of(commands) << '\n';
   }
 
   return commands;
 }
+
+void solver::ponder() {
+  if (!last_state.end) ai.ponder(last_state, last_step);
+}
@@ -2,16 +2,27 @@
 #define SOLVER_H_INCLUDED
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "AI.h"
+#include "Deadline.h"
 
 class solver {
  public:
   AI ai;
-  void startMessage(const std::vector<std::string>& startInfos);
-  std::vector<std::string> processTick(const std::vector<std::string>& infos);
+  void startMessage(const std::vector<std::string_view>& startInfos);
+  std::vector<std::string> processTick(const std::vector<std::string_view>& infos, const Deadline& deadline = {});
+  // The same for the decoded messages of the binary protocol
+  void start(InitialData initial_data);
+  Step step(GameState&& state, const Deadline& deadline = {});
+  // Call after the response of processTick is sent, uses the time until the next tick
+  void ponder();
+
+ private:
+  GameState last_state;
+  Step last_step;
 };
 
 #endif  // SOLVER_H_INCLUDED
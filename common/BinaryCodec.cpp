@@ -0,0 +1,358 @@
+#include "BinaryCodec.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace binary {
+
+namespace {
+
+template <typename T>
+void put(string& out, T value) {
+  auto bits = static_cast<make_unsigned_t<T>>(value);
+  for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>(bits >> (8 * i) & 0xff));
+}
+
+void put(string& out, Pos pos) {
+  put<uint8_t>(out, pos.y);
+  put<uint8_t>(out, pos.x);
+}
+
+// The records of the entities, without their position
+void put(string& out, const Vampire& vampire) {
+  put<uint8_t>(out, vampire.id);
+  put<uint8_t>(out, vampire.health);
+  put<uint8_t>(out, vampire.grenades);
+  put<uint8_t>(out, vampire.range);
+  put<uint8_t>(out, vampire.shoes);
+}
+
+void put(string& out, const Grenade& grenade) {
+  put<uint8_t>(out, grenade.vampire_id);
+  put<uint8_t>(out, grenade.tick);
+  put<uint8_t>(out, grenade.range);
+}
+
+void put(string& out, const Powerup& powerup) {
+  put<uint8_t>(out, static_cast<uint8_t>(powerup.type));
+  put<int16_t>(out, powerup.ticks);
+  put<int16_t>(out, powerup.protect);
+}
+
+void put(string& out, const Bat& bat) { put<uint8_t>(out, bat.density); }
+
+template <typename T>
+void put_entity(string& out, const T& entity) {
+  put(out, entity.pos);
+  put(out, entity);
+}
+
+// Reserves the length, which end_frame fills in
+size_t begin_frame(string& out, FrameType type) {
+  size_t start = out.size();
+  put<uint32_t>(out, 0);
+  put<uint8_t>(out, static_cast<uint8_t>(type));
+  return start;
+}
+
+void end_frame(string& out, size_t start) {
+  uint32_t length = out.size() - start - sizeof(uint32_t);
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) out[start + i] = static_cast<char>(length >> (8 * i) & 0xff);
+}
+
+class Reader {
+ public:
+  explicit Reader(string_view data) : data(data) {}
+
+  template <typename T>
+  T get() {
+    if (data.size() < sizeof(T)) throw runtime_error("Truncated binary message");
+    make_unsigned_t<T> bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) bits |= static_cast<make_unsigned_t<T>>((uint8_t)data[i]) << (8 * i);
+    data.remove_prefix(sizeof(T));
+    return static_cast<T>(bits);
+  }
+  Pos get_pos() {
+    int y = get<uint8_t>();
+    return {y, get<uint8_t>()};
+  }
+  void get(Vampire& vampire) {
+    vampire.id = get<uint8_t>();
+    vampire.health = get<uint8_t>();
+    vampire.grenades = get<uint8_t>();
+    vampire.range = get<uint8_t>();
+    vampire.shoes = get<uint8_t>();
+  }
+  void get(Grenade& grenade) {
+    grenade.vampire_id = get<uint8_t>();
+    grenade.tick = get<uint8_t>();
+    grenade.range = get<uint8_t>();
+  }
+  void get(Powerup& powerup) {
+    powerup.type = static_cast<PowerupType>(get<uint8_t>());
+    powerup.ticks = get<int16_t>();
+    powerup.protect = get<int16_t>();
+  }
+  void get(Bat& bat) { bat.density = get<uint8_t>(); }
+  template <typename T>
+  void get_entity(T& entity) {
+    entity.pos = get_pos();
+    get(entity);
+  }
+  string_view get_bytes(size_t count) {
+    if (data.size() < count) throw runtime_error("Truncated binary message");
+    string_view bytes = data.substr(0, count);
+    data.remove_prefix(count);
+    return bytes;
+  }
+
+ private:
+  string_view data;
+};
+
+// The fields of the records, the ones the text protocol sends too
+bool same(const Vampire& a, const Vampire& b) {
+  return a.id == b.id && a.pos == b.pos && a.health == b.health && a.grenades == b.grenades && a.range == b.range &&
+         a.shoes == b.shoes;
+}
+bool same(const Grenade& a, const Grenade& b) {
+  return a.vampire_id == b.vampire_id && a.pos == b.pos && a.tick == b.tick && a.range == b.range;
+}
+bool same(const Powerup& a, const Powerup& b) {
+  return a.type == b.type && a.pos == b.pos && a.ticks == b.ticks && a.protect == b.protect;
+}
+bool same(const Bat& a, const Bat& b) { return a.pos == b.pos && a.density == b.density; }
+
+// The end of the entities on the field of entities[begin]
+template <typename T>
+size_t field_end(const vector<T>& entities, size_t begin) {
+  size_t end = begin;
+  while (end < entities.size() && entities[end].pos == entities[begin].pos) ++end;
+  return end;
+}
+
+// Writes the fields whose entities differ between base and state, each as its position, the number of entities on it
+// and their records. Both lists are ordered by position, the way Grid::get_state lists them, so one pass compares
+// them and the order of the entities on a field is kept.
+template <typename T>
+void put_changed_fields(string& out, const vector<T>& base, const vector<T>& state) {
+  size_t count_at = out.size();
+  put<uint16_t>(out, 0);
+  uint16_t count = 0;
+  for (size_t i = 0, j = 0; i < base.size() || j < state.size();) {
+    Pos pos = i == base.size() ? state[j].pos : j == state.size() ? base[i].pos : min(base[i].pos, state[j].pos);
+    size_t base_end = i < base.size() && base[i].pos == pos ? field_end(base, i) : i;
+    size_t state_end = j < state.size() && state[j].pos == pos ? field_end(state, j) : j;
+    bool changed = base_end - i != state_end - j;
+    for (size_t k = 0; !changed && k < base_end - i; ++k) changed = !same(base[i + k], state[j + k]);
+    if (changed) {
+      put(out, pos);
+      put<uint8_t>(out, state_end - j);
+      for (size_t k = j; k < state_end; ++k) put(out, state[k]);
+      ++count;
+    }
+    i = base_end;
+    j = state_end;
+  }
+  out[count_at] = static_cast<char>(count & 0xff);
+  out[count_at + 1] = static_cast<char>(count >> 8);
+}
+
+// Replaces the entities of the fields put_changed_fields wrote. Returns false if the fields are not in increasing
+// order, the entities could not be kept ordered then.
+template <typename T>
+bool apply_changed_fields(Reader& in, vector<T>& entities) {
+  int count = in.get<uint16_t>();
+  vector<T> field;
+  Pos previous{};
+  for (int i = 0; i < count; ++i) {
+    Pos pos = in.get_pos();
+    if (i > 0 && !(previous < pos)) return false;
+    previous = pos;
+    field.resize(in.get<uint8_t>());
+    for (T& entity : field) {
+      entity.pos = pos;
+      in.get(entity);
+    }
+    auto begin = lower_bound(entities.begin(), entities.end(), pos, [](const T& a, Pos b) { return a.pos < b; });
+    auto end = begin;
+    while (end != entities.end() && end->pos == pos) ++end;
+    begin = entities.erase(begin, end);
+    entities.insert(begin, field.begin(), field.end());
+  }
+  return true;
+}
+
+}  // namespace
+
+void encode(string& out, const InitialData& initial_data) {
+  size_t start = begin_frame(out, FrameType::INITIAL_DATA);
+  put<int32_t>(out, initial_data.level);
+  put<int32_t>(out, initial_data.game_id);
+  put<uint8_t>(out, initial_data.test);
+  put<int32_t>(out, initial_data.max_tick);
+  put<int32_t>(out, initial_data.grenade_radius);
+  put<int32_t>(out, initial_data.size);
+  put<uint16_t>(out, initial_data.message.size());
+  out += initial_data.message;
+  end_frame(out, start);
+}
+
+void encode_request(string& out, int game_id, int tick, int vampire_id, const GameState& state) {
+  size_t start = begin_frame(out, FrameType::REQUEST);
+  put<int32_t>(out, game_id);
+  put<int32_t>(out, tick);
+  put<uint8_t>(out, vampire_id);
+  put<uint8_t>(out, state.vampires.size());
+  for (const Vampire& vampire : state.vampires) put_entity(out, vampire);
+  put<uint16_t>(out, state.grenades.size());
+  for (const Grenade& grenade : state.grenades) put_entity(out, grenade);
+  put<uint16_t>(out, state.powerups.size());
+  for (const Powerup& powerup : state.powerups) put_entity(out, powerup);
+  for (int density = 1; density <= 3; ++density) {
+    size_t count_at = out.size();
+    put<uint16_t>(out, 0);
+    uint16_t count = 0;
+    for (const Bat& bat : state.bats) {
+      if (bat.density != density) continue;
+      put(out, bat.pos);
+      ++count;
+    }
+    out[count_at] = static_cast<char>(count & 0xff);
+    out[count_at + 1] = static_cast<char>(count >> 8);
+  }
+  end_frame(out, start);
+}
+
+void encode(string& out, const Response& response) {
+  const Step& step = response.step;
+  size_t start = begin_frame(out, FrameType::RESPONSE);
+  put<int32_t>(out, response.game_id);
+  put<int32_t>(out, response.tick);
+  put<uint8_t>(out, response.vampire_id);
+  const auto& thro = step.throw_grenades;
+  put<uint8_t>(out, step.place_grenade | thro.has_value() << 1 | (thro.has_value() && thro->from_place) << 2);
+  put<uint8_t>(out, thro.has_value() ? static_cast<uint8_t>(thro->dir) : 0);
+  put<uint8_t>(out, thro.has_value() ? thro->length : 0);
+  put<uint8_t>(out, step.move.has_value() ? step.move->size() : 0);
+  if (step.move.has_value()) {
+    for (Direction dir : *step.move) put<uint8_t>(out, static_cast<uint8_t>(dir));
+  }
+  end_frame(out, start);
+}
+
+void encode_delta(string& out, int game_id, int tick, int vampire_id, uint32_t sequence, const GameState* base,
+                  const GameState& state) {
+  static const GameState empty;
+  size_t start = begin_frame(out, FrameType::DELTA);
+  put<int32_t>(out, game_id);
+  put<int32_t>(out, tick);
+  put<uint8_t>(out, vampire_id);
+  put<uint32_t>(out, sequence);
+  put<uint8_t>(out, base == nullptr);
+  if (!base) base = &empty;
+  put_changed_fields(out, base->vampires, state.vampires);
+  put_changed_fields(out, base->grenades, state.grenades);
+  put_changed_fields(out, base->powerups, state.powerups);
+  put_changed_fields(out, base->bats, state.bats);
+  end_frame(out, start);
+}
+
+void encode_resync(string& out, int game_id, int tick, int vampire_id) {
+  size_t start = out.size();
+  encode(out, Response{game_id, tick, vampire_id, {}});
+  out[start + sizeof(uint32_t)] = static_cast<char>(FrameType::RESYNC);
+}
+
+void encode_wrong(string& out, string_view reason) {
+  size_t start = begin_frame(out, FrameType::WRONG);
+  out += reason;
+  end_frame(out, start);
+}
+
+bool split_frame(string_view& data, FrameType& type, string_view& payload) {
+  if (data.size() < sizeof(uint32_t)) return false;
+  uint32_t length = Reader(data).get<uint32_t>();
+  if (length == 0) throw runtime_error("Binary frame without a type");
+  if (data.size() - sizeof(uint32_t) < length) return false;
+  type = static_cast<FrameType>(data[sizeof(uint32_t)]);
+  payload = data.substr(sizeof(uint32_t) + 1, length - 1);
+  data.remove_prefix(sizeof(uint32_t) + length);
+  return true;
+}
+
+InitialData decode_initial_data(string_view payload) {
+  Reader in(payload);
+  InitialData initial_data;
+  initial_data.level = in.get<int32_t>();
+  initial_data.game_id = in.get<int32_t>();
+  initial_data.test = in.get<uint8_t>();
+  initial_data.max_tick = in.get<int32_t>();
+  initial_data.grenade_radius = in.get<int32_t>();
+  initial_data.size = in.get<int32_t>();
+  initial_data.message = in.get_bytes(in.get<uint16_t>());
+  return initial_data;
+}
+
+GameState decode_state(string_view payload) {
+  Reader in(payload);
+  GameState state;
+  state.game_id = in.get<int32_t>();
+  state.tick = in.get<int32_t>();
+  state.vampire_id = in.get<uint8_t>();
+  state.vampires.resize(in.get<uint8_t>());
+  for (Vampire& vampire : state.vampires) in.get_entity(vampire);
+  state.grenades.resize(in.get<uint16_t>());
+  for (Grenade& grenade : state.grenades) in.get_entity(grenade);
+  state.powerups.resize(in.get<uint16_t>());
+  for (Powerup& powerup : state.powerups) in.get_entity(powerup);
+  for (int density = 1; density <= 3; ++density) {
+    int count = in.get<uint16_t>();
+    for (int i = 0; i < count; ++i) state.bats.push_back({in.get_pos(), density});
+  }
+  return state;
+}
+
+bool apply_delta(string_view payload, GameState& state, uint32_t& sequence) {
+  Reader in(payload);
+  int game_id = in.get<int32_t>();
+  int tick = in.get<int32_t>();
+  int vampire_id = in.get<uint8_t>();
+  uint32_t delta_sequence = in.get<uint32_t>();
+  bool keyframe = in.get<uint8_t>();
+  if (keyframe) state = GameState();
+  state.game_id = game_id;
+  state.tick = tick;
+  state.vampire_id = vampire_id;
+  if (!keyframe && delta_sequence != sequence + 1) return false;
+  if (!apply_changed_fields(in, state.vampires) || !apply_changed_fields(in, state.grenades) ||
+      !apply_changed_fields(in, state.powerups) || !apply_changed_fields(in, state.bats)) {
+    return false;
+  }
+  sequence = delta_sequence;
+  return true;
+}
+
+Response decode_response(string_view payload) {
+  Reader in(payload);
+  Response response{};
+  response.game_id = in.get<int32_t>();
+  response.tick = in.get<int32_t>();
+  response.vampire_id = in.get<uint8_t>();
+  uint8_t flags = in.get<uint8_t>();
+  uint8_t dir = in.get<uint8_t>();
+  uint8_t length = in.get<uint8_t>();
+  Step& step = response.step;
+  step.place_grenade = flags & 1;
+  if (flags & 2) step.throw_grenades = Throw{(flags & 4) != 0, static_cast<Direction>(dir & 3), length};
+  // Like in the text protocol, no move is sent as an empty one
+  if (int count = in.get<uint8_t>()) {
+    step.move = vector<Direction>(count);
+    for (Direction& move : *step.move) move = static_cast<Direction>(in.get<uint8_t>() & 3);
+  }
+  return response;
+}
+
+}  // namespace binary
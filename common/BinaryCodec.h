@@ -0,0 +1,57 @@
+#ifndef ITECH21_BINARYCODEC_H
+#define ITECH21_BINARYCODEC_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "GameState.h"
+
+// The binary protocol a bot can ask for by adding login_token to its LOGIN line. After the login every message is a
+// frame: a uint32 length of the rest, a FrameType and the payload, with little endian numbers. Entities are fixed
+// width records, positions and the counters of vampires take a byte each. The state of a request lists the bats
+// grouped by density, like the text protocol.
+//
+// Adding delta_login_token too, the requests are DELTA frames instead: the fields of the map whose vampires, grenades,
+// powerups or bats changed since the previous request, with all their entities. A keyframe lists every entity, it is
+// sent first and then periodically. The frames are numbered, a bot that gets a delta to a state it doesn't have
+// answers with RESYNC, and the next request is a keyframe.
+namespace binary {
+
+inline constexpr std::string_view login_token = "BINARY";
+inline constexpr std::string_view delta_login_token = "DELTA";
+
+enum class FrameType : uint8_t { INITIAL_DATA, REQUEST, RESPONSE, WRONG, DELTA, RESYNC };
+
+struct Response {
+  int game_id, tick, vampire_id;
+  Step step;
+};
+
+// The frames are appended to out
+void encode(std::string& out, const InitialData& initial_data);
+void encode_request(std::string& out, int game_id, int tick, int vampire_id, const GameState& state);
+// The entities of the states are ordered by position, as Grid::get_state lists them. Without a base it is a keyframe.
+void encode_delta(std::string& out, int game_id, int tick, int vampire_id, uint32_t sequence, const GameState* base,
+                  const GameState& state);
+void encode(std::string& out, const Response& response);
+// A response without a step, the header of the request it answers
+void encode_resync(std::string& out, int game_id, int tick, int vampire_id);
+void encode_wrong(std::string& out, std::string_view reason);
+
+// Splits the first frame off data if it is complete
+bool split_frame(std::string_view& data, FrameType& type, std::string_view& payload);
+
+// Throw std::runtime_error if the payload is too short
+InitialData decode_initial_data(std::string_view payload);
+GameState decode_state(std::string_view payload);
+// The payload of a RESYNC frame is a response too
+Response decode_response(std::string_view payload);
+// Applies a DELTA payload to state, the state of sequence. If it is a delta to another one, only the header of the
+// request is taken and it returns false. It also returns false if the fields of the payload are out of order, state is
+// left half updated then and only a keyframe can fix it.
+bool apply_delta(std::string_view payload, GameState& state, uint32_t& sequence);
+
+}  // namespace binary
+
+#endif  // ITECH21_BINARYCODEC_H
@@ -1,51 +1,69 @@
 #include "GameState.h"
 
-#include <sstream>
+#include <algorithm>
+#include <stdexcept>
 #include <unordered_set>
 
+#include "Scanner.h"
+#include "Writer.h"
 #include "utility.h"
 
 using namespace std;
 
-InitialData::InitialData(const std::vector<std::string>& lines) {
-  unordered_set<string> initial_commands{"LEVEL", "GAMEID", "TEST", "MAXTICK", "GRENADERADIUS", "SIZE"};
-  for (const string& line : lines) {
-    stringstream stream(line);
-    string keyword;
-    stream >> keyword;
-    if (keyword == "MESSAGE")
-      stream >> message;
-    else if (keyword == "LEVEL")
-      stream >> level;
-    else if (keyword == "GAMEID")
-      stream >> game_id;
-    else if (keyword == "TEST")
-      stream >> test;
-    else if (keyword == "MAXTICK")
-      stream >> max_tick;
-    else if (keyword == "GRENADERADIUS")
-      stream >> grenade_radius;
-    else if (keyword == "SIZE")
-      stream >> size;
-    else
-      error("Unknown command keyword: " + keyword);
-    if (stream.fail()) {
-      error("Failed to parse command from line: " + line);
-    }
-    if (keyword != "MESSAGE" && !initial_commands.erase(keyword)) {
-      error("Duplicate command: " + line);
-    }
+// The keywords are removed from initial_commands as they are read
+void parse_line(InitialData& data, string_view line, unordered_set<string_view>& initial_commands) {
+  Scanner stream(line);
+  string_view keyword;
+  stream >> keyword;
+  if (keyword == "MESSAGE")
+    stream >> data.message;
+  else if (keyword == "LEVEL")
+    stream >> data.level;
+  else if (keyword == "GAMEID")
+    stream >> data.game_id;
+  else if (keyword == "TEST")
+    stream >> data.test;
+  else if (keyword == "MAXTICK")
+    stream >> data.max_tick;
+  else if (keyword == "GRENADERADIUS")
+    stream >> data.grenade_radius;
+  else if (keyword == "SIZE")
+    stream >> data.size;
+  else
+    error("Unknown command keyword: " + string(keyword));
+  if (stream.fail()) {
+    error("Failed to parse command from line: " + string(line));
   }
+  if (keyword != "MESSAGE" && !initial_commands.erase(keyword)) {
+    error("Duplicate command: " + string(line));
+  }
+}
+
+void check_missing(const unordered_set<string_view>& initial_commands) {
   if (!initial_commands.empty()) {
     string message = "Missing commands:";
-    for (const string& keyword : initial_commands) {
-      message += " " + keyword;
+    for (string_view keyword : initial_commands) {
+      message += " " + string(keyword);
     }
     error(message);
   }
 }
 
-std::ostream& operator<<(ostream& out, const InitialData& initial_data) {
+const unordered_set<string_view> all_initial_commands{"LEVEL", "GAMEID", "TEST", "MAXTICK", "GRENADERADIUS", "SIZE"};
+
+InitialData::InitialData(const std::vector<std::string>& lines) {
+  unordered_set<string_view> initial_commands = all_initial_commands;
+  for (const string& line : lines) parse_line(*this, line, initial_commands);
+  check_missing(initial_commands);
+}
+
+InitialData::InitialData(const std::vector<std::string_view>& lines) {
+  unordered_set<string_view> initial_commands = all_initial_commands;
+  for (string_view line : lines) parse_line(*this, line, initial_commands);
+  check_missing(initial_commands);
+}
+
+Writer& operator<<(Writer& out, const InitialData& initial_data) {
   if (!initial_data.message.empty()) {
     out << "MESSAGE " << initial_data.message << '\n';
   }
@@ -54,92 +72,128 @@ std::ostream& operator<<(ostream& out, const InitialData& initial_data) {
              << "TEST " << (int)initial_data.test << '\n'
              << "MAXTICK " << initial_data.max_tick << '\n'
              << "GRENADERADIUS " << initial_data.grenade_radius << '\n'
-             << "SIZE " << initial_data.size << endl;
+             << "SIZE " << initial_data.size << '\n';
 }
 
-GameState::GameState(const vector<string>& lines) {
-  for (const string& line : lines) {
-    stringstream stream(line);
-    string keyword;
-    stream >> keyword;
-    if (keyword == "REQ") {
-      stream >> game_id >> tick >> vampire_id;
-    } else if (keyword == "WARN") {
-      string warning;
-      stream >> warning;
-      warnings.push_back(move(warning));
-    } else if (keyword == "VAMPIRE") {
-      Vampire vampire{};
-      stream >> vampire.id >> vampire.pos >> vampire.health >> vampire.grenades >> vampire.range >> vampire.shoes;
-      vampires.push_back(vampire);
-    } else if (keyword == "GRENADE") {
-      Grenade grenade{};
-      stream >> grenade.vampire_id >> grenade.pos >> grenade.tick >> grenade.range;
-      grenades.push_back(grenade);
-    } else if (keyword == "POWERUP") {
-      Powerup powerup{};
-      string type;
-      stream >> type >> powerup.ticks >> powerup.pos >> powerup.protect;
-      if (type == "TOMATO")
-        powerup.type = PowerupType::TOMATO;
-      else if (type == "GRENADE")
-        powerup.type = PowerupType::GRENADE;
-      else if (type == "BATTERY")
-        powerup.type = PowerupType::BATTERY;
-      else if (type == "SHOE")
-        powerup.type = PowerupType::SHOE;
-      else
-        error("Unknown powerup type: " + type);
-      powerups.push_back(powerup);
-    } else if (keyword.substr(0, 3) == "BAT") {
-      int density = stoi(keyword.substr(3));
-      Pos pos;
-      while (stream >> pos) {
-        bats.push_back({pos, density});
-      }
-    } else if (keyword == "END") {
-      end = true;
-    } else {
-      error("Unknown command keyword: " + keyword);
+void parse_line(GameState& state, string_view line) {
+  Scanner stream(line);
+  string_view keyword;
+  stream >> keyword;
+  if (keyword == "REQ") {
+    stream >> state.game_id >> state.tick >> state.vampire_id;
+  } else if (keyword == "WARN") {
+    string warning;
+    stream >> warning;
+    state.warnings.push_back(move(warning));
+  } else if (keyword == "VAMPIRE") {
+    Vampire vampire{};
+    stream >> vampire.id >> vampire.pos >> vampire.health >> vampire.grenades >> vampire.range >> vampire.shoes;
+    state.vampires.push_back(vampire);
+  } else if (keyword == "GRENADE") {
+    Grenade grenade{};
+    stream >> grenade.vampire_id >> grenade.pos >> grenade.tick >> grenade.range;
+    state.grenades.push_back(grenade);
+  } else if (keyword == "POWERUP") {
+    Powerup powerup{};
+    string_view type;
+    stream >> type >> powerup.ticks >> powerup.pos >> powerup.protect;
+    if (type == "TOMATO")
+      powerup.type = PowerupType::TOMATO;
+    else if (type == "GRENADE")
+      powerup.type = PowerupType::GRENADE;
+    else if (type == "BATTERY")
+      powerup.type = PowerupType::BATTERY;
+    else if (type == "SHOE")
+      powerup.type = PowerupType::SHOE;
+    else
+      error("Unknown powerup type: " + string(type));
+    state.powerups.push_back(powerup);
+  } else if (keyword.substr(0, 3) == "BAT") {
+    int density;
+    if (!(Scanner(keyword.substr(3)) >> density)) throw invalid_argument("stoi");  // like stoi did
+    Pos pos;
+    while (stream >> pos) {
+      state.bats.push_back({pos, density});
     }
-    // This would be triggered because of the while (stream >> target_pos) loop
-    // if (stream.fail()) {
-    //   error("Failed to parse command from line: " + line);
-    // }
+  } else if (keyword == "END") {
+    state.end = true;
+  } else {
+    error("Unknown command keyword: " + string(keyword));
   }
+  // This would be triggered because of the while (stream >> target_pos) loop
+  // if (stream.fail()) {
+  //   error("Failed to parse command from line: " + line);
+  // }
+}
+
+GameState::GameState(const vector<string>& lines) {
+  for (const string& line : lines) parse_line(*this, line);
+}
+
+GameState::GameState(const vector<string_view>& lines) {
+  for (string_view line : lines) parse_line(*this, line);
+}
+
+GameState GameState::request_for(int game_id, int vampire_id) const {
+  GameState request;
+  request.game_id = game_id;
+  request.tick = tick;
+  request.vampire_id = vampire_id;
+  request.vampires = vampires;
+  for (Vampire& vampire : request.vampires) vampire.invulnerable = 0;
+  request.grenades = grenades;
+  request.powerups = powerups;
+  request.bats = bats;
+  stable_sort(request.bats.begin(), request.bats.end(),
+              [](const Bat& a, const Bat& b) { return a.density < b.density; });
+  return request;
 }
 
-std::ostream& operator<<(std::ostream& out, const Vampire& vampire) {
+Writer& operator<<(Writer& out, const Vampire& vampire) {
   return out << "VAMPIRE " << vampire.id << ' ' << vampire.pos << ' ' << vampire.health << ' ' << vampire.grenades
-             << ' ' << vampire.range << ' ' << vampire.shoes << endl;
+             << ' ' << vampire.range << ' ' << vampire.shoes << '\n';
 }
 
-std::ostream& operator<<(std::ostream& out, const Grenade& grenade) {
+Writer& operator<<(Writer& out, const Grenade& grenade) {
   return out << "GRENADE " << grenade.vampire_id << ' ' << grenade.pos << ' ' << grenade.tick << ' ' << grenade.range
-             << endl;
+             << '\n';
 }
 
 const string powerup_type_names[] = {"TOMATO", "GRENADE", "BATTERY", "SHOE"};
-std::ostream& operator<<(std::ostream& out, const Powerup& powerup) {
+Writer& operator<<(Writer& out, const Powerup& powerup) {
   return out << "POWERUP " << powerup_type_names[(int)powerup.type] << ' ' << powerup.ticks << ' ' << powerup.pos << ' '
-             << powerup.protect << endl;
+             << powerup.protect << '\n';
 }
 
-std::ostream& operator<<(std::ostream& out, const GameState& game_state) {
+Writer& operator<<(Writer& out, const GameState& game_state) {
   for (const auto& vampire : game_state.vampires) out << vampire;
   for (const auto& grenade : game_state.grenades) out << grenade;
   for (const auto& powerup : game_state.powerups) out << powerup;
-  vector<Pos> bats_by_density[4];
-  for (const auto& bat : game_state.bats) bats_by_density[bat.density].push_back(bat.pos);
-  for (int i = 1; i <= 3; i++) {
-    if (bats_by_density[i].empty()) continue;
-    out << "BAT" << i;
-    for (const Pos& pos : bats_by_density[i]) out << ' ' << pos;
-    out << endl;
+  for (int density = 1; density <= 3; density++) {
+    bool first = true;
+    for (const auto& bat : game_state.bats) {
+      if (bat.density != density) continue;
+      if (first) out << "BAT" << density;
+      out << ' ' << bat.pos;
+      first = false;
+    }
+    if (!first) out << '\n';
   }
   return out;
 }
 
+template <typename T>
+ostream& write_text(ostream& out, const T& value) {
+  Writer writer;
+  writer << value;
+  return out << writer.str();
+}
+ostream& operator<<(ostream& out, const InitialData& initial_data) { return write_text(out, initial_data); }
+ostream& operator<<(ostream& out, const Vampire& vampire) { return write_text(out, vampire); }
+ostream& operator<<(ostream& out, const Grenade& grenade) { return write_text(out, grenade); }
+ostream& operator<<(ostream& out, const Powerup& powerup) { return write_text(out, powerup); }
+ostream& operator<<(ostream& out, const GameState& game_state) { return write_text(out, game_state); }
+
 string Throw::to_string() const {
   string command = "THROW ";
   if (from_place) command += "X";
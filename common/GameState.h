@@ -5,8 +5,10 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Writer.h"
 #include "positions.h"
 
 enum class PowerupType { TOMATO, GRENADE, BATTERY, SHOE };
@@ -22,21 +24,26 @@ struct InitialData {
   int grenade_radius{};
   int size{};
   explicit InitialData(const std::vector<std::string>& lines);
+  // Parses the lines in place
+  explicit InitialData(const std::vector<std::string_view>& lines);
   InitialData() = default;
 };
 std::ostream& operator<<(std::ostream& out, const InitialData& initial_data);
+Writer& operator<<(Writer& out, const InitialData& initial_data);
 
 struct Vampire {
   Pos pos;
   int id, health = 0, grenades, range, shoes, invulnerable = 0;
 };
 std::ostream& operator<<(std::ostream& out, const Vampire& vampire);
+Writer& operator<<(Writer& out, const Vampire& vampire);
 
 struct Grenade {
   Pos pos;
   int vampire_id, tick, range;
 };
 std::ostream& operator<<(std::ostream& out, const Grenade& grenade);
+Writer& operator<<(Writer& out, const Grenade& grenade);
 
 struct Powerup {
   PowerupType type;
@@ -44,6 +51,7 @@ struct Powerup {
   int ticks, protect;
 };
 std::ostream& operator<<(std::ostream& out, const Powerup& powerup);
+Writer& operator<<(Writer& out, const Powerup& powerup);
 
 struct Bat {
   Pos pos;
@@ -61,9 +69,15 @@ struct GameState {
   std::vector<Bat> bats;
   bool end = false;
   explicit GameState(const std::vector<std::string>& lines);
+  // Parses the lines in place
+  explicit GameState(const std::vector<std::string_view>& lines);
   GameState() = default;
+  // What the server sends to vampire_id of this state: the same as writing the request and parsing it, without the
+  // fields that are not sent, like invulnerable, and with the bats grouped by density
+  GameState request_for(int game_id, int vampire_id) const;
 };
 std::ostream& operator<<(std::ostream& out, const GameState& game_state);
+Writer& operator<<(Writer& out, const GameState& game_state);
 
 struct Throw {
   bool from_place = false;
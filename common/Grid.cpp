@@ -230,7 +230,7 @@ void Grid::place_possible_grenades(int self_id) {
   }
 }
 
-vector<Pos> Grid::from_where_can_throw_to(Pos target) {
+vector<Pos> Grid::from_where_can_throw_to(Pos target) const {
   const Field& to = field_at(target);
   if (to.is_bush || to.bat.has_value()) return {};
   vector<Pos> froms;
@@ -397,19 +397,7 @@ void Grid::step_grenades() {
 
 void Grid::switch_lights_at_end() {
   for (int nTh = 0; nTh < tick - max_tick; nTh++) {
-    int size = fields.size();
-    int j = size * size - 4 * nTh;
-    if (j >= 0) {
-      int line = (size - sqrt(j)) / 2;
-      int column = nTh - line * (size - 1 - line);
-
-      fields[line][column].has_light = true;
-      if (line != (size - 1) / 2) {
-        fields[column][size - 1 - line].has_light = true;
-        fields[size - 1 - column][line].has_light = true;
-        fields[size - 1 - line][size - 1 - column].has_light = true;
-      }
-    }
+    for_ring_fields(fields.size(), nTh, [this](const Pos& pos) { field_at(pos).has_light = true; });
   }
 }
 
@@ -1,6 +1,7 @@
 #ifndef ITECH21_GRID_H
 #define ITECH21_GRID_H
 
+#include <cmath>
 #include <map>
 #include <optional>
 #include <queue>
@@ -61,7 +62,7 @@ class Grid {
   void init(const GameState& state, const InitialData& init_data);
   const GameState& get_state() const;
   void place_possible_grenades(int self_id);
-  std::vector<Pos> from_where_can_throw_to(Pos target);
+  std::vector<Pos> from_where_can_throw_to(Pos target) const;
 
   void step(const std::map<int, Step>& vampire_steps = {});
 
@@ -75,9 +76,28 @@ class Grid {
   void step_vampires(std::map<int, Step> vampire_steps);  // We make a copy of the map here
   void handle_throw(const Throw& thro, const Vampire& vampire);
   void switch_lights_at_end();
+  // Calls f with the fields lit in the nTh tick after max_tick, returns false if there are none.
+  // The ring closes in from the edges.
+  template <typename F>
+  static bool for_ring_fields(int size, int nTh, F f);
 
  private:
   mutable std::optional<GameState> state_cache;
 };
 
+template <typename F>
+bool Grid::for_ring_fields(int size, int nTh, F f) {
+  int j = size * size - 4 * nTh;
+  if (j < 0) return false;
+  int line = (size - sqrt(j)) / 2;
+  int column = nTh - line * (size - 1 - line);
+  f(Pos{line, column});
+  if (line != (size - 1) / 2) {
+    f(Pos{column, size - 1 - line});
+    f(Pos{size - 1 - column, line});
+    f(Pos{size - 1 - line, size - 1 - column});
+  }
+  return true;
+}
+
 #endif  // ITECH21_GRID_H
@@ -0,0 +1,141 @@
+#include "Log.h"
+
+#include <chrono>
+
+using namespace std;
+
+Log::Log() {
+  for (size_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, memory_order_relaxed);
+  writer = thread(&Log::run, this);
+}
+
+Log::~Log() {
+  stopping = true;
+  wake();
+  writer.join();
+  if (file != stderr) fclose(file);
+}
+
+Log& Log::instance() {
+  static Log log;
+  return log;
+}
+
+void Log::open(const string& path, Format format) {
+  FILE* file = fopen(path.c_str(), format == Format::BINARY ? "wb" : "w");
+  if (!file) {
+    LOG(ERR) << "Can't open log file " << path;
+    return;
+  }
+  Log& log = instance();
+  log.requested_format = format;
+  log.requested_file.store(file, memory_order_release);
+  log.wake();
+  // The writer switches files between lines, the lines logged before go to the previous one
+  unique_lock<mutex> lock(log.wait_mutex);
+  log.idle.wait(lock, [&] { return !log.requested_file.load(memory_order_acquire); });
+}
+
+void Log::flush() {
+  Log& log = instance();
+  unique_lock<mutex> lock(log.wait_mutex);
+  log.idle.wait(lock, [&] { return log.tail.load(memory_order_acquire) == log.head.load(memory_order_acquire); });
+}
+
+void Log::wake() {
+  lock_guard<mutex> lock(wait_mutex);
+  wakeup.notify_one();
+}
+
+// A bounded multi-producer queue: a slot can be pushed to when its sequence equals the position, and written out when
+// it is one more
+void Log::push(LogLevel level, string&& text) {
+  size_t pos = head.load(memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots[pos & (capacity - 1)];
+    size_t sequence = slot->sequence.load(memory_order_acquire);
+    if (sequence == pos) {
+      if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+    } else if (sequence < pos) {
+      dropped.fetch_add(1, memory_order_relaxed);
+      return;
+    } else {
+      pos = head.load(memory_order_relaxed);
+    }
+  }
+  slot->level = level;
+  slot->time = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+  slot->text = move(text);
+  slot->sequence.store(pos + 1, memory_order_release);
+  // The writer sets sleeping before it looks for lines, so either it finds this one or we see it sleeping
+  atomic_thread_fence(memory_order_seq_cst);
+  if (sleeping.load(memory_order_relaxed)) wake();
+}
+
+bool Log::has_line() const {
+  size_t pos = tail.load(memory_order_relaxed);
+  return slots[pos & (capacity - 1)].sequence.load(memory_order_acquire) == pos + 1;
+}
+
+bool Log::pop_and_write() {
+  size_t pos = tail.load(memory_order_relaxed);
+  Slot& slot = slots[pos & (capacity - 1)];
+  if (slot.sequence.load(memory_order_acquire) != pos + 1) return false;
+  write(slot.level, slot.time, slot.text);
+  slot.sequence.store(pos + capacity, memory_order_release);
+  tail.store(pos + 1, memory_order_release);
+  return true;
+}
+
+void Log::write(LogLevel level, uint64_t time, const string& text) {
+  if (format == Format::BINARY) {
+    uint8_t level_byte = (uint8_t)level;
+    uint32_t length = text.size();
+    fwrite(&time, sizeof(time), 1, file);
+    fwrite(&level_byte, sizeof(level_byte), 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+  } else if (level == LogLevel::WARN) {
+    fputs("WARNING ", file);
+  } else if (level == LogLevel::ERR) {
+    fputs("ERROR ", file);
+  }
+  fwrite(text.data(), 1, text.size(), file);
+  if (format == Format::TEXT) fputc('\n', file);
+}
+
+void Log::run() {
+  while (true) {
+    if (pop_and_write()) continue;
+    size_t lost = dropped.exchange(0, memory_order_relaxed);
+    if (lost) write(LogLevel::WARN, 0, to_string(lost) + " log lines dropped");
+    fflush(file);
+    if (FILE* requested = requested_file.load(memory_order_acquire)) {
+      if (file != stderr) fclose(file);
+      file = requested;
+      format = requested_format;
+      requested_file.store(nullptr, memory_order_release);
+    }
+    unique_lock<mutex> lock(wait_mutex);
+    idle.notify_all();
+    if (stopping) break;
+    sleeping.store(true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    wakeup.wait(lock, [&] { return has_line() || stopping || requested_file.load(memory_order_acquire); });
+    sleeping.store(false, memory_order_relaxed);
+  }
+}
+
+void Log::dump(istream& in, ostream& out) {
+  static const char* prefixes[] = {"", "", "WARNING ", "ERROR "};
+  uint64_t time;
+  uint8_t level;
+  uint32_t length;
+  string text;
+  while (in.read((char*)&time, sizeof(time)) && in.read((char*)&level, sizeof(level)) &&
+         in.read((char*)&length, sizeof(length))) {
+    text.resize(length);
+    in.read(text.data(), length);
+    out << time / 1e6 << ' ' << prefixes[level & 3] << text << '\n';
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef ITECH21_LOG_H
+#define ITECH21_LOG_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+enum class LogLevel { DEBUG, INFO, WARN, ERR, NONE };
+
+// Lines below this level are compiled out, set by the LOG_LEVEL CMake option
+#ifndef ITECH21_LOG_LEVEL
+#define ITECH21_LOG_LEVEL 1
+#endif
+inline constexpr LogLevel min_log_level = (LogLevel)ITECH21_LOG_LEVEL;
+
+// LOG(INFO) << "Score: " << score; writes one line. Nothing after LOG is evaluated for a level that is compiled
+// out or filtered out by Log::set_level, and a callable taking an std::ostream& is only called if the line is written,
+// e.g.
+// LOG(DEBUG) << [&](std::ostream& os) { grid.print(os); };
+#define LOG(level)                                  \
+  if constexpr (LogLevel::level < min_log_level) { \
+  } else                                            \
+    Log::Line(LogLevel::level)
+
+// The lines are formatted by the threads logging them and pushed into a lock-free ring buffer, a background thread
+// writes them out, it sleeps on a condition variable while there is nothing to write. When the buffer is full, lines
+// are dropped instead of blocking the caller.
+class Log {
+ public:
+  enum class Format { TEXT, BINARY };
+
+  class Line {
+   public:
+    explicit Line(LogLevel level) : level(level) {
+      if (level >= Log::instance().level) stream.emplace();
+    }
+    ~Line() {
+      if (stream) Log::instance().push(level, stream->str());
+    }
+
+    template <typename T>
+    Line& operator<<(const T& value) {
+      if (!stream) return *this;
+      if constexpr (std::is_invocable_v<const T&, std::ostream&>) {
+        value(*stream);
+      } else {
+        *stream << value;
+      }
+      return *this;
+    }
+
+   private:
+    LogLevel level;
+    std::optional<std::ostringstream> stream;  // only for the lines that are written
+  };
+
+  // Text goes to stderr until a file is opened. Binary records are a uint64 microsecond timestamp, a uint8 level, a
+  // uint32 length and the text, see dump.
+  static void open(const std::string& path, Format format);
+  // Waits until the lines logged so far are written
+  static void flush();
+  // Drops the lines below level at runtime, on top of LOG_LEVEL
+  static void set_level(LogLevel level) { instance().level = level; }
+  // Converts a binary log to text
+  static void dump(std::istream& in, std::ostream& out);
+
+  ~Log();
+
+ private:
+  static const size_t capacity = 4096;  // a power of 2
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    LogLevel level;
+    uint64_t time;
+    std::string text;
+  };
+
+  std::array<Slot, capacity> slots;
+  alignas(64) std::atomic<size_t> head{0};  // the next slot to push to
+  alignas(64) std::atomic<size_t> tail{0};  // the next slot to write out, only moved by the writer
+  std::atomic<size_t> dropped{0};
+  std::atomic<LogLevel> level{LogLevel::DEBUG};
+  std::atomic<bool> stopping{false};
+  std::atomic<bool> sleeping{false};  // the writer waits for wakeup
+  std::mutex wait_mutex;
+  std::condition_variable wakeup;  // for the writer, when there is something to do
+  std::condition_variable idle;    // from the writer, when it has written everything
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::FILE* file = stderr;  // only used by the writer
+  Format format = Format::TEXT;
+  std::atomic<std::FILE*> requested_file{nullptr};
+  Format requested_format = Format::TEXT;
+  std::thread writer;
+
+  Log();
+  static Log& instance();
+  void push(LogLevel level, std::string&& text);
+  bool has_line() const;
+  bool pop_and_write();
+  void wake();
+  void write(LogLevel level, uint64_t time, const std::string& text);
+  void run();
+};
+
+#endif  // ITECH21_LOG_H
@@ -0,0 +1,85 @@
+#include "Scanner.h"
+
+#include <cctype>
+#include <charconv>
+#include <limits>
+
+using namespace std;
+
+bool Scanner::getline(string_view& text, string_view& line) {
+  if (text.empty()) return false;
+  size_t end = text.find('\n');
+  line = text.substr(0, end);
+  text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+  return true;
+}
+
+void Scanner::skip_whitespace() {
+  size_t i = 0;
+  while (i < text.size() && isspace((unsigned char)text[i])) ++i;
+  text.remove_prefix(i);
+}
+
+string_view Scanner::word() {
+  if (failed) return {};
+  skip_whitespace();
+  size_t i = 0;
+  while (i < text.size() && !isspace((unsigned char)text[i])) ++i;
+  string_view result = text.substr(0, i);
+  text.remove_prefix(i);
+  if (result.empty()) failed = true;
+  return result;
+}
+
+// Like reading an std::string, the value is cleared if there is no word left
+Scanner& Scanner::operator>>(string_view& value) {
+  if (!failed) value = word();
+  return *this;
+}
+
+Scanner& Scanner::operator>>(string& value) {
+  if (!failed) value = word();
+  return *this;
+}
+
+Scanner& Scanner::operator>>(char& value) {
+  if (failed) return *this;
+  skip_whitespace();
+  if (text.empty()) {
+    failed = true;
+  } else {
+    value = text[0];
+    text.remove_prefix(1);
+  }
+  return *this;
+}
+
+Scanner& Scanner::operator>>(int& value) {
+  if (failed) return *this;
+  skip_whitespace();
+  // from_chars takes no '+' sign
+  size_t sign = text.size() > 1 && text[0] == '+' && isdigit((unsigned char)text[1]) ? 1 : 0;
+  auto [end, result] = from_chars(text.data() + sign, text.data() + text.size(), value);
+  if (result == errc::result_out_of_range) {
+    value = text[0] == '-' ? numeric_limits<int>::min() : numeric_limits<int>::max();
+    failed = true;
+  } else if (result != errc{}) {
+    value = 0;
+    failed = true;
+  }
+  text.remove_prefix(end - text.data());
+  return *this;
+}
+
+Scanner& Scanner::operator>>(bool& value) {
+  if (failed) return *this;
+  int number;
+  *this >> number;
+  if (failed) {
+    value = false;
+  } else {
+    value = number != 0;
+    if (number != 0 && number != 1) failed = true;
+  }
+  return *this;
+}
@@ -0,0 +1,37 @@
+#ifndef ITECH21_SCANNER_H
+#define ITECH21_SCANNER_H
+
+#include <string>
+#include <string_view>
+
+#include "positions.h"
+
+// Reads the words and numbers of a message in place, like an std::istringstream would without copying the text: the
+// values are separated by whitespace, an extraction that fails sets the value of numbers to 0, and the ones after it
+// do nothing.
+class Scanner {
+ public:
+  explicit Scanner(std::string_view text) : text(text) {}
+
+  // Splits off the next line of text without its '\n', like std::getline. Returns false if there are no more lines.
+  static bool getline(std::string_view& text, std::string_view& line);
+
+  std::string_view word();
+  Scanner& operator>>(std::string_view& value);
+  Scanner& operator>>(std::string& value);
+  Scanner& operator>>(char& value);
+  Scanner& operator>>(int& value);
+  Scanner& operator>>(bool& value);
+  Scanner& operator>>(Pos& pos) { return *this >> pos.y >> pos.x; }
+
+  bool fail() const { return failed; }
+  explicit operator bool() const { return !failed; }
+
+ private:
+  std::string_view text;  // the part not read yet
+  bool failed = false;
+
+  void skip_whitespace();
+};
+
+#endif  // ITECH21_SCANNER_H
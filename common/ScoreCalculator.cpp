@@ -4,30 +4,36 @@
 
 using namespace std;
 
+void ScoreCalculator::add(int type, int vampire_id, double score) {
+  if (vampire_id >= (int)total_score.size()) {
+    total_score.resize(vampire_id + 1);
+    for (auto& type_scores : scores) type_scores.resize(vampire_id + 1);
+  }
+  scores[type][vampire_id] += score;
+  total_score[vampire_id] += score;
+}
+
 void ScoreCalculator::init_from_grid(const Grid& grid) {
   scores.resize(grid.scores.size());
   for (size_t i = 0; i < scores.size(); i++) {
-    scores[i] = map<int, double>(grid.scores[i].begin(), grid.scores[i].end());
-    for (const auto& vampire_score : scores[i]) total_score[vampire_score.first] += vampire_score.second;
+    for (const auto& vampire_score : grid.scores[i]) add(i, vampire_score.first, vampire_score.second);
   }
 }
 
-void ScoreCalculator::update(const GameState& game_state, const InitialData& init_data) {
-  Grid grid(game_state, init_data);
-  grid.step();
+void ScoreCalculator::update(const Grid& grid, const GameState& game_state) {
   for (const Vampire& vampire : game_state.vampires) {
     for (size_t i = 0; i < scores.size(); i++) {
-      scores[i][vampire.id] += grid.scores[i][vampire.id];
-      total_score[vampire.id] += grid.scores[i][vampire.id];
+      auto score = grid.scores[i].find(vampire.id);
+      add(i, vampire.id, score == grid.scores[i].end() ? 0 : score->second);
     }
   }
 }
 
-void print_helper(ostream& os, const string& score_type, const map<int, double>& scores) {
+void print_helper(ostream& os, const string& score_type, const vector<double>& scores) {
   os << score_type;
   os << fixed << setprecision(2);
-  for (const auto& vampire_score : scores) {
-    os << setw(8) << vampire_score.second;
+  for (size_t vampire_id = 1; vampire_id < scores.size(); vampire_id++) {
+    os << setw(8) << scores[vampire_id];
   }
   os << endl;
 }
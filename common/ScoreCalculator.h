@@ -1,23 +1,28 @@
 #ifndef ITECH21_SCORECALCULATOR_H
 #define ITECH21_SCORECALCULATOR_H
 
-#include <map>
+#include <ostream>
+#include <vector>
 
 #include "GameState.h"
 #include "Grid.h"
 
 class ScoreCalculator {
  public:
-  // The first index is ScoreType, and the inner maps are indexed by vampire id
-  std::vector<std::map<int, double>> scores;
-  std::map<int, double> total_score;
+  // The first index is ScoreType, the second one is the vampire id, 0 is unused
+  std::vector<std::vector<double>> scores;
+  std::vector<double> total_score;  // by vampire id
 
   ScoreCalculator() { scores.resize(4); }
 
   void init_from_grid(const Grid& grid);
-  void update(const GameState& game_state, const InitialData& init_data);
+  // Adds the scores of the vampires of game_state in grid, which has just made the step from game_state
+  void update(const Grid& grid, const GameState& game_state);
 
   void print(std::ostream& os) const;
+
+ private:
+  void add(int type, int vampire_id, double score);
 };
 
 #endif  // ITECH21_SCORECALCULATOR_H
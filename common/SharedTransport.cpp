@@ -0,0 +1,156 @@
+#include "SharedTransport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+// Not FUTEX_PRIVATE_FLAG, the word is shared between processes
+long futex(atomic<uint32_t>& word, int op, uint32_t value, const timespec* timeout = nullptr) {
+  return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, value, timeout, nullptr, 0);
+}
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+// Spinning before sleeping saves the wakeup when the other process answers fast, if it has a core of its own
+const int spin_count = thread::hardware_concurrency() > 1 ? 4000 : 0;
+
+}  // namespace
+
+void SharedTransport::Doorbell::ring() {
+  rings.fetch_add(1);
+  if (sleepers.load()) futex(rings, FUTEX_WAKE, INT_MAX);
+}
+
+void SharedTransport::Doorbell::wait(uint32_t seen, chrono::steady_clock::time_point deadline) {
+  for (int i = 0; i < spin_count; ++i) {
+    if (rings.load(memory_order_acquire) != seen) return;
+    cpu_relax();
+  }
+  auto now = chrono::steady_clock::now();
+  if (now >= deadline) return;
+  auto left = chrono::duration_cast<chrono::nanoseconds>(deadline - now).count();
+  timespec timeout{static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+  sleepers.fetch_add(1);
+  futex(rings, FUTEX_WAIT, seen, &timeout);
+  sleepers.fetch_sub(1);
+}
+
+bool SharedTransport::Ring::write(string_view message, pid_t reader) {
+  auto next_check = chrono::steady_clock::time_point::min();
+  while (!message.empty()) {
+    uint64_t begin = head.load(memory_order_relaxed);
+    size_t room = capacity - (begin - tail.load(memory_order_acquire));
+    if (room == 0) {
+      // Only a reader that stopped reading fills the ring, so it is not worth a doorbell
+      auto now = chrono::steady_clock::now();
+      if (now >= next_check) {
+        if (!alive(reader)) return false;
+        next_check = now + liveness_interval;
+      }
+      this_thread::sleep_for(100us);
+      continue;
+    }
+    size_t count = min(room, message.size());
+    size_t offset = begin & (capacity - 1);
+    size_t first = min(count, capacity - offset);
+    memcpy(data + offset, message.data(), first);
+    memcpy(data, message.data() + first, count - first);
+    head.store(begin + count, memory_order_release);
+    message.remove_prefix(count);
+  }
+  return true;
+}
+
+size_t SharedTransport::Ring::read(char* buffer, size_t size) {
+  uint64_t begin = tail.load(memory_order_relaxed);
+  size_t count = min<uint64_t>(size, head.load(memory_order_acquire) - begin);
+  size_t offset = begin & (capacity - 1);
+  size_t first = min(count, capacity - offset);
+  memcpy(buffer, data + offset, first);
+  memcpy(buffer + first, data, count - first);
+  tail.store(begin + count, memory_order_release);
+  return count;
+}
+
+SharedTransport::SharedTransport(string name, bool owner, void* memory, size_t size)
+    : name{move(name)}, owner{owner}, memory{memory}, size{size} {}
+
+SharedTransport::~SharedTransport() {
+  munmap(memory, size);
+  if (owner) shm_unlink(name.c_str());
+}
+
+size_t SharedTransport::size_for(int player_count) {
+  return (sizeof(Header) + alignof(Channel) - 1) / alignof(Channel) * alignof(Channel) + player_count * sizeof(Channel);
+}
+
+unique_ptr<SharedTransport> SharedTransport::create(const string& name, int player_count) {
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) throw runtime_error("Can't create shared memory " + name + ": " + strerror(errno));
+  size_t size = size_for(player_count);
+  void* memory = ftruncate(fd, size) ? MAP_FAILED : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw runtime_error("Can't map shared memory " + name + ": " + strerror(errno));
+  }
+  unique_ptr<SharedTransport> transport(new SharedTransport(name, true, memory, size));
+  Header& header = *new (memory) Header{getpid(), player_count, {}};
+  for (int player = 1; player <= header.player_count; ++player) new (&transport->channel(player)) Channel;
+  return transport;
+}
+
+unique_ptr<SharedTransport> SharedTransport::open(const string& name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) throw runtime_error("Can't open shared memory " + name + ": " + strerror(errno));
+  void* memory = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+  size_t size = memory == MAP_FAILED ? 0 : size_for(static_cast<Header*>(memory)->player_count);
+  if (memory != MAP_FAILED) munmap(memory, sizeof(Header));
+  memory = size ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close(fd);
+  if (memory == MAP_FAILED) throw runtime_error("Can't map shared memory " + name + ": " + strerror(errno));
+  return unique_ptr<SharedTransport>(new SharedTransport(name, false, memory, size));
+}
+
+SharedTransport::Header& SharedTransport::header() const { return *static_cast<Header*>(memory); }
+
+SharedTransport::Channel& SharedTransport::channel(int player) {
+  if (player < 1 || player > header().player_count) throw out_of_range("No player " + to_string(player));
+  auto* first = static_cast<char*>(memory) + size_for(0);
+  return reinterpret_cast<Channel*>(first)[player - 1];
+}
+
+SharedTransport::Doorbell& SharedTransport::server_doorbell() { return header().server_doorbell; }
+
+pid_t SharedTransport::server_pid() const { return header().server_pid; }
+
+bool SharedTransport::alive(pid_t pid) {
+  if (pid == 0) return true;
+  if (kill(pid, 0) != 0) return errno == EPERM;
+  // A killed process is a zombie until it is reaped, the peers are not each other's children
+  ifstream stat("/proc/" + to_string(pid) + "/stat");
+  string line;
+  getline(stat, line);
+  size_t name_end = line.rfind(')');
+  return name_end == string::npos || name_end + 2 >= line.size() || line[name_end + 2] != 'Z';
+}
@@ -0,0 +1,92 @@
+#ifndef ITECH21_SHAREDTRANSPORT_H
+#define ITECH21_SHAREDTRANSPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <sys/types.h>
+
+// The server and the bots on the same host can talk through a POSIX shared memory object instead of FIFOs, Linux
+// only. Each player has a byte ring per direction with a single writer and a single reader, so a message is a memcpy,
+// and the reader is only woken by a futex when it sleeps. The bots all wake the same doorbell of the server, so it can
+// wait for any of them.
+class SharedTransport {
+ public:
+  // Counts the writes, a futex word
+  struct Doorbell {
+    std::atomic<uint32_t> rings{0};
+    std::atomic<uint32_t> sleepers{0};
+
+    void ring();
+    // Returns when rings differs from seen or the deadline passes, seen is read before checking for data
+    void wait(uint32_t seen, std::chrono::steady_clock::time_point deadline);
+  };
+
+  class Ring {
+   public:
+    static constexpr size_t capacity = 1 << 20;  // a power of 2
+
+    // Blocks while the ring is full, returns false if the reader with pid reader exits meanwhile
+    bool write(std::string_view data, pid_t reader);
+    // Copies up to size bytes, returns the number copied
+    size_t read(char* buffer, size_t size);
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> closed{false};  // by the writer, after its last write
+
+   private:
+    alignas(64) std::atomic<uint64_t> head{0};  // bytes written
+    alignas(64) std::atomic<uint64_t> tail{0};  // bytes read
+    alignas(64) char data[capacity];
+  };
+
+  struct Channel {
+    std::atomic<pid_t> bot_pid{0};  // set by the bot when it opens the channel
+    Doorbell bot_doorbell;
+    Ring to_bot;
+    Ring to_server;
+  };
+
+  // The environment variables the server passes the name of the object and the player to the bots in
+  static constexpr const char* name_variable = "ITECH21_SHM";
+  static constexpr const char* player_variable = "ITECH21_SHM_PLAYER";
+
+  // By the server, the object is removed when it is destroyed
+  static std::unique_ptr<SharedTransport> create(const std::string& name, int player_count);
+  // By a bot
+  static std::unique_ptr<SharedTransport> open(const std::string& name);
+  ~SharedTransport();
+
+  // Players are numbered from 1, like the vampires
+  Channel& channel(int player);
+  Doorbell& server_doorbell();
+  // For the bots to notice if the server is gone without closing
+  pid_t server_pid() const;
+  // A peer that is killed can't close its rings, so waits are cut into these to check it. 0 is a peer that has not
+  // shown up yet, it is taken to be alive.
+  static constexpr std::chrono::milliseconds liveness_interval{100};
+  static bool alive(pid_t pid);
+
+ private:
+  struct Header {
+    pid_t server_pid;
+    int player_count;
+    Doorbell server_doorbell;
+  };
+
+  std::string name;
+  bool owner;
+  void* memory;
+  size_t size;
+
+  SharedTransport(std::string name, bool owner, void* memory, size_t size);
+  Header& header() const;
+  static size_t size_for(int player_count);
+};
+
+#endif  // ITECH21_SHAREDTRANSPORT_H
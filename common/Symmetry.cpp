@@ -0,0 +1,121 @@
+#include "Symmetry.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "Grid.h"
+
+using namespace std;
+
+vector<Transform> Transform::all(int size) {
+  vector<Transform> transforms;
+  for (bool mirror : {false, true}) {
+    for (int rotation = 0; rotation < 4; ++rotation) transforms.push_back({size, mirror, rotation});
+  }
+  return transforms;
+}
+
+Pos Transform::apply(Pos pos) const {
+  if (mirror) pos.x = size - 1 - pos.x;
+  for (int i = 0; i < rotation; ++i) pos = {pos.x, size - 1 - pos.y};
+  return pos;
+}
+
+Direction Transform::apply(Direction dir) const {
+  Pos delta = pos_deltas[(int)dir];
+  if (mirror) delta.x = -delta.x;
+  for (int i = 0; i < rotation; ++i) delta = {delta.x, -delta.y};
+  return directions[find(pos_deltas.begin(), pos_deltas.end(), delta) - pos_deltas.begin()];
+}
+
+Step Transform::apply(const Step& step) const {
+  Step result = step;
+  if (result.throw_grenades.has_value()) result.throw_grenades->dir = apply(result.throw_grenades->dir);
+  if (result.move.has_value()) {
+    for (Direction& dir : result.move.value()) dir = apply(dir);
+  }
+  return result;
+}
+
+GameState Transform::apply(const GameState& state) const {
+  GameState result = state;
+  for (Vampire& vampire : result.vampires) vampire.pos = apply(vampire.pos);
+  for (Grenade& grenade : result.grenades) grenade.pos = apply(grenade.pos);
+  for (Powerup& powerup : result.powerups) powerup.pos = apply(powerup.pos);
+  for (Bat& bat : result.bats) bat.pos = apply(bat.pos);
+  return result;
+}
+
+// Reflections are their own inverses
+Transform Transform::inverse() const { return {size, mirror, mirror ? rotation : (4 - rotation) % 4}; }
+
+void append_value(string& key, int value) {
+  key.push_back((char)value);
+  key.push_back((char)(value >> 8));
+}
+
+string encode_state(const GameState& state, const Transform& transform, int self_id) {
+  vector<pair<string, int>> vampires;  // encoding, id
+  for (const Vampire& vampire : state.vampires) {
+    Pos pos = transform.apply(vampire.pos);
+    string encoding;
+    for (int value : {pos.y, pos.x, vampire.health, vampire.grenades, vampire.range, vampire.shoes,
+                      vampire.invulnerable}) {
+      append_value(encoding, value);
+    }
+    vampires.emplace_back(move(encoding), vampire.id);
+  }
+  sort(vampires.begin(), vampires.end(), [self_id](const auto& a, const auto& b) {
+    return make_pair(a.second != self_id, a.first) < make_pair(b.second != self_id, b.first);
+  });
+  auto rank_of = [&vampires](int id) {
+    return (int)(find_if(vampires.begin(), vampires.end(), [id](const auto& v) { return v.second == id; }) -
+                 vampires.begin());
+  };
+
+  string key;
+  append_value(key, state.tick);
+  append_value(key, vampires.size());
+  for (const auto& vampire : vampires) key += vampire.first;
+
+  vector<tuple<Pos, int, int, int>> grenades;
+  for (const Grenade& grenade : state.grenades) {
+    grenades.emplace_back(transform.apply(grenade.pos), grenade.tick, grenade.range, rank_of(grenade.vampire_id));
+  }
+  sort(grenades.begin(), grenades.end());
+  append_value(key, grenades.size());
+  for (const auto& [pos, tick, range, owner] : grenades) {
+    for (int value : {pos.y, pos.x, tick, range, owner}) append_value(key, value);
+  }
+
+  vector<tuple<Pos, int, int, int>> powerups;
+  for (const Powerup& powerup : state.powerups) {
+    powerups.emplace_back(transform.apply(powerup.pos), (int)powerup.type, powerup.ticks, powerup.protect);
+  }
+  sort(powerups.begin(), powerups.end());
+  append_value(key, powerups.size());
+  for (const auto& [pos, type, ticks, protect] : powerups) {
+    for (int value : {pos.y, pos.x, type, ticks, protect}) append_value(key, value);
+  }
+
+  vector<pair<Pos, int>> bats;
+  for (const Bat& bat : state.bats) bats.emplace_back(transform.apply(bat.pos), bat.density);
+  sort(bats.begin(), bats.end());
+  for (const auto& [pos, density] : bats) {
+    for (int value : {pos.y, pos.x, density}) append_value(key, value);
+  }
+  return key;
+}
+
+CanonicalKey canonical_key(const GameState& state, int size, int self_id) {
+  CanonicalKey result;
+  for (const Transform& transform : Transform::all(size)) {
+    string key = encode_state(state, transform, self_id);
+    if (result.key.empty() || key < result.key) result = {move(key), transform};
+  }
+  return result;
+}
+
+CanonicalKey canonical_key(const Grid& grid, int self_id) {
+  return canonical_key(grid.get_state(), grid.fields.size(), self_id);
+}
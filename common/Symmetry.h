@@ -0,0 +1,40 @@
+#ifndef ITECH21_SYMMETRY_H
+#define ITECH21_SYMMETRY_H
+
+#include <string>
+#include <vector>
+
+#include "GameState.h"
+#include "positions.h"
+
+class Grid;
+
+// One of the 8 symmetries of the square board: an optional mirror (x -> size - 1 - x) followed by rotation * 90
+// degrees clockwise. The bushes of every map are symmetric under all of them.
+struct Transform {
+  int size = 0;
+  bool mirror = false;
+  int rotation = 0;
+
+  static std::vector<Transform> all(int size);
+
+  Pos apply(Pos pos) const;
+  Direction apply(Direction dir) const;
+  Step apply(const Step& step) const;
+  GameState apply(const GameState& state) const;
+  Transform inverse() const;
+};
+
+// The same key for states that are symmetric images of each other, apart from the ids of the vampires.
+// transform takes the state to the canonical one, so a Step stored for the key is played as
+// transform.inverse().apply(step).
+struct CanonicalKey {
+  std::string key;
+  Transform transform;
+};
+
+// The vampire with self_id comes first in the key, the others are ordered by their data
+CanonicalKey canonical_key(const GameState& state, int size, int self_id);
+CanonicalKey canonical_key(const Grid& grid, int self_id);
+
+#endif  // ITECH21_SYMMETRY_H
@@ -0,0 +1,12 @@
+#include "Writer.h"
+
+#include <charconv>
+
+using namespace std;
+
+Writer& Writer::operator<<(int value) {
+  char digits[16];
+  auto [end, result] = to_chars(digits, digits + sizeof(digits), value);
+  buffer.append(digits, end);
+  return *this;
+}
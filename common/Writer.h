@@ -0,0 +1,31 @@
+#ifndef ITECH21_WRITER_H
+#define ITECH21_WRITER_H
+
+#include <string>
+#include <string_view>
+
+#include "positions.h"
+
+// Formats a whole message into one buffer, so it can be written out at once. The counterpart of Scanner.
+class Writer {
+ public:
+  Writer& operator<<(std::string_view text) {
+    buffer.append(text);
+    return *this;
+  }
+  Writer& operator<<(const char* text) { return *this << std::string_view(text); }
+  Writer& operator<<(char c) {
+    buffer.push_back(c);
+    return *this;
+  }
+  Writer& operator<<(int value);
+  Writer& operator<<(const Pos& pos) { return *this << pos.y << ' ' << pos.x; }
+
+  std::string_view str() const { return buffer; }
+  void clear() { buffer.clear(); }
+
+ private:
+  std::string buffer;
+};
+
+#endif  // ITECH21_WRITER_H
@@ -1,13 +1,14 @@
 #include "utility.h"
 
-#include <iostream>
 #include <stdexcept>
 
+#include "Log.h"
+
 using namespace std;
 
 void error(const string& message) {
 #ifdef NDEBUG
-  cerr << "ERROR " << message << endl;
+  LOG(ERR) << message;
 #else
   throw runtime_error(message);
 #endif
@@ -2,7 +2,9 @@
 #define ITECH21_UTILITY_H
 
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
 
 #ifndef NDEBUG
 #define NDEBUG
@@ -17,12 +19,33 @@ class OutTee {
  public:
   std::ofstream pipe;
   std::ofstream log;
-  OutTee(std::string pipe_name) : pipe{pipe_name}, log{pipe_name + ".log"} {}
+  std::ostringstream buffer;
+  // Without the pipe only the log is written
+  OutTee(std::string pipe_name, bool open_pipe = true) : log{pipe_name + ".log"} {
+    if (open_pipe) pipe.open(pipe_name);
+  }
+  // Writes a whole message with one write to the pipe, and one to the buffer of the log
+  void send(std::string_view message) {
+    pipe.write(message.data(), message.size());
+    pipe.flush();
+    log.write(message.data(), message.size());
+  }
+  // The same for a binary frame, logged as the text of the message
+  void send(std::string_view frame, std::string_view text) {
+    pipe.write(frame.data(), frame.size());
+    pipe.flush();
+    log.write(text.data(), text.size());
+  }
 };
+// The text is formatted once. Only the pipe is flushed when a line ends, the log is written out by its buffer.
 template <typename T>
 OutTee& operator<<(OutTee& out, const T& t) {
-  out.pipe << t;
-  out.log << t;
+  out.buffer.str("");
+  out.buffer << t;
+  std::string text = out.buffer.str();
+  out.pipe << text;
+  if (!text.empty() && text.back() == '\n') out.pipe.flush();
+  out.log << text;
   return out;
 }
 
@@ -1 +1,136 @@
 #include "Player.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "../common/BinaryCodec.h"
+
+using namespace std;
+
+Player::Player(int vampire_id, SharedTransport* transport)
+    : vampire_id{vampire_id},
+      name{"player" + std::to_string(vampire_id)},
+      input{name + ".in", !transport},
+      transport{transport} {
+  if (transport) return;
+  // Blocks until the bot opens the other end, like the ifstream did
+  output = open((name + ".out").c_str(), O_RDONLY);
+  if (output >= 0) fcntl(output, F_SETFL, fcntl(output, F_GETFL) | O_NONBLOCK);
+}
+
+Player::Player(Player&& other) noexcept
+    : vampire_id{other.vampire_id},
+      name{move(other.name)},
+      input{move(other.input)},
+      output{other.output},
+      transport{other.transport},
+      received{move(other.received)},
+      used_time{other.used_time},
+      late_responses{other.late_responses},
+      binary_protocol{other.binary_protocol},
+      delta_states{other.delta_states},
+      delta_base{move(other.delta_base)},
+      sequence{other.sequence},
+      exited{other.exited} {
+  other.output = -1;
+  other.transport = nullptr;
+}
+
+Player::~Player() {
+  if (output >= 0) close(output);
+  if (transport) {
+    transport->channel(vampire_id).to_bot.closed = true;
+    transport->channel(vampire_id).bot_doorbell.ring();
+  }
+}
+
+void Player::send(string_view data, string_view text) {
+  if (transport) {
+    SharedTransport::Channel& channel = transport->channel(vampire_id);
+    // A bot that is gone can't answer either, receive notices it
+    channel.to_bot.write(data, channel.bot_pid);
+    channel.bot_doorbell.ring();
+    input.log.write(text.data(), text.size());
+  } else {
+    input.send(data, text);
+  }
+}
+
+bool Player::ready() const {
+  const SharedTransport::Ring& ring = transport->channel(vampire_id).to_server;
+  return !ring.empty() || ring.closed || exited;
+}
+
+void Player::check_alive() { exited = !SharedTransport::alive(transport->channel(vampire_id).bot_pid); }
+
+bool Player::receive() {
+  if (transport) {
+    SharedTransport::Ring& ring = transport->channel(vampire_id).to_server;
+    bool closed = ring.closed || exited;  // before reading, so the last write is not missed
+    char buffer[4096];
+    while (size_t count = ring.read(buffer, sizeof(buffer))) received.append(buffer, count);
+    return !closed;
+  }
+  char buffer[4096];
+  while (true) {
+    ssize_t count = read(output, buffer, sizeof(buffer));
+    if (count > 0) {
+      received.append(buffer, count);
+    } else if (count < 0 && errno == EINTR) {
+      continue;
+    } else {
+      return count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+  }
+}
+
+optional<string> Player::next_message() {
+  size_t end;
+  if (binary_protocol) {
+    string_view rest = received;
+    binary::FrameType type;
+    string_view payload;
+    try {
+      if (!binary::split_frame(rest, type, payload)) return nullopt;
+      end = received.size() - rest.size();
+    } catch (const runtime_error&) {
+      // Nothing after a malformed frame can be trusted, parse_response answers all of it with WRONG
+      end = received.size();
+    }
+  } else if (received.compare(0, 2, ".\n") == 0) {
+    end = 2;
+  } else {
+    end = received.find("\n.\n");
+    if (end == string::npos) return nullopt;
+    end += 3;
+  }
+  string message = received.substr(0, end);
+  received.erase(0, end);
+  return message;
+}
+
+optional<string> Player::read_message(chrono::steady_clock::time_point deadline) {
+  while (true) {
+    if (auto message = next_message()) return message;
+    auto now = chrono::steady_clock::now();
+    if (now >= deadline) return nullopt;
+    if (transport) {
+      uint32_t seen = transport->server_doorbell().rings.load();
+      if (!ready()) {
+        transport->server_doorbell().wait(seen, min(deadline, now + SharedTransport::liveness_interval));
+        if (transport->server_doorbell().rings.load() == seen) check_alive();
+      }
+      if (!receive()) return next_message();
+      continue;
+    }
+    pollfd fd{output, POLLIN, 0};
+    int timeout = chrono::duration_cast<chrono::milliseconds>(deadline - now).count() + 1;
+    if (poll(&fd, 1, timeout) < 0 && errno != EINTR) return nullopt;
+    if (fd.revents && !receive()) return next_message();
+  }
+}
@@ -2,9 +2,13 @@
 #define ITECH21_PLAYER_H
 
 #include <chrono>
-#include <fstream>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 
+#include "../common/GameState.h"
+#include "../common/SharedTransport.h"
 #include "../common/utility.h"
 
 using namespace std::chrono_literals;
@@ -14,13 +18,36 @@ class Player {
   int vampire_id;
   std::string name;
   OutTee input;
-  std::ifstream output;  // the player's output is an input for the server
+  int output = -1;        // the player's output is an input for the server, read without blocking
+  SharedTransport* transport = nullptr;  // used instead of the FIFOs when the server runs with --shm
+  std::string received;  // the part of the output that is not a complete message yet
+  std::chrono::milliseconds used_time{0};  // counted against config::global_timeout
+  int late_responses = 0;                  // to the requests we have stopped waiting for, dropped when they arrive
+  bool binary_protocol = false;            // negotiated at login, the messages after it are binary frames
+  bool delta_states = false;               // the requests are DELTA frames, to delta_base
+  std::optional<GameState> delta_base;     // the state of the last request, none when a keyframe is due
+  uint32_t sequence = 0;                   // of the last request
+  bool exited = false;                     // with shared memory, the bot is gone without closing its ring
 
-  Player(int vampire_id)
-      : vampire_id{vampire_id},
-        name{"player" + std::to_string(vampire_id)},
-        input{name + ".in"},
-        output{name + ".out"} {}
+  Player(int vampire_id, SharedTransport* transport = nullptr);
+  Player(Player&& other) noexcept;
+  ~Player();
+
+  // Writes a whole message to the player and its text to the log of the input
+  void send(std::string_view message) { send(message, message); }
+  void send(std::string_view data, std::string_view text);
+  // The shared memory transport is ready to be read, because the player has written or closed it
+  bool ready() const;
+  // Sets exited if the bot has been killed. Only called after a doorbell wait timed out, it takes syscalls.
+  void check_alive();
+
+  // Reads what the player has written, returns false if it has closed its output
+  bool receive();
+  // Removes the first complete message from received, with its closing "." line, or the first frame. After a malformed
+  // frame everything received is taken, to be answered with WRONG.
+  std::optional<std::string> next_message();
+  // Waits for the next message, nullopt if the player closes its output or the deadline passes before
+  std::optional<std::string> read_message(std::chrono::steady_clock::time_point deadline);
 };
 
 #endif  // ITECH21_PLAYER_H
@@ -1,7 +1,15 @@
 #include "Simulation.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <fstream>
+#include <tuple>
+#include <utility>
 
+#include <poll.h>
+
+#include "../common/BinaryCodec.h"
+#include "../common/Log.h"
 #include "../common/ScoreCalculator.h"
 #include "protocol.h"
 
@@ -19,7 +27,7 @@ Simulation::Simulation(vector<Player> players, int seed, const string& level_fil
     getline(f, line);
   }
   init_data = InitialData(lines);
-  cerr << init_data << endl;
+  LOG(INFO) << init_data;
 
   lines = {};
   getline(f, line);
@@ -32,8 +40,16 @@ Simulation::Simulation(vector<Player> players, int seed, const string& level_fil
 }
 
 void Simulation::run() {
+  message.clear();
+  message << init_data << protocol::EndMessage{};
+  frame.clear();
+  binary::encode(frame, init_data);
   for (Player& player : players) {
-    player.input << init_data << protocol::EndMessage{};
+    if (player.binary_protocol) {
+      player.send(frame, message.str());
+    } else {
+      player.send(message.str());
+    }
   }
   int num_vampires = grid.get_state().vampires.size();
   ofstream match_log("match.log");
@@ -41,57 +57,173 @@ void Simulation::run() {
     //    grid.print(cerr);
     GameState game_state = grid.get_state();
     num_vampires = game_state.vampires.size();
-    match_log << game_state << endl;
+    state_text.clear();
+    state_text << game_state;
+    match_log << state_text.str() << endl;
+    // The requests go out to every living player before any response is read, so the bots think at the same time
     map<int, Step> vampire_steps;
+    vector<PendingRequest> pending;
     for (Player& player : players) {
       for (const auto& vampire : game_state.vampires) {
-        // Only send if alive
-        if (player.vampire_id == vampire.id) {
-          send_request(player, game_state);
-          vampire_steps[player.vampire_id] = receive_response(player);
-        }
+        // Only send if alive, the players out of time stay in place
+        if (player.vampire_id != vampire.id) continue;
+        vampire_steps[player.vampire_id] = {};
+        if (player.used_time < config::global_timeout) pending.push_back(send_request(player, game_state));
       }
     }
+    // Only vampires without a player are left, e.g. in a game of fewer bots than the map has vampires. Without steps
+    // the grid doesn't count their invulnerability down, so they would never die.
+    if (vampire_steps.empty()) break;
+    receive_responses(move(pending), vampire_steps);
     grid.step(vampire_steps);
   }
   ScoreCalculator score_calculator;
   score_calculator.init_from_grid(grid);
-  score_calculator.print(cerr);
+  LOG(INFO) << [&](ostream& os) { score_calculator.print(os); };
   ofstream scores("scores.json");
   scores << "[";
   bool first = true;
-  for (auto vampire_score : score_calculator.total_score) {
-    scores << (first ? "" : ", ") << vampire_score.second;
+  // Every player is listed, also the ones who have not scored
+  for (const Player& player : players) {
+    size_t vampire_id = player.vampire_id;
+    scores << (first ? "" : ", ")
+           << (vampire_id < score_calculator.total_score.size() ? score_calculator.total_score[vampire_id] : 0);
     first = false;
   }
   scores << "]\n";
 }
 
-void Simulation::send_request(Player& player, const GameState& game_state) const {
-  player.input << protocol::Request{init_data.game_id, grid.tick, player.vampire_id};
-  player.input << game_state << protocol::EndMessage{};
+Simulation::PendingRequest Simulation::send_request(Player& player, const GameState& game_state) {
+  message.clear();
+  message << protocol::Request{init_data.game_id, grid.tick, player.vampire_id} << state_text.str()
+          << protocol::EndMessage{};
+  if (player.delta_states) {
+    if (++player.sequence % config::keyframe_interval == 0) player.delta_base.reset();
+    frame.clear();
+    binary::encode_delta(frame, init_data.game_id, grid.tick, player.vampire_id, player.sequence,
+                         player.delta_base ? &*player.delta_base : nullptr, game_state);
+    player.send(frame, message.str());
+    player.delta_base = game_state;
+  } else if (player.binary_protocol) {
+    frame.clear();
+    binary::encode_request(frame, init_data.game_id, grid.tick, player.vampire_id, game_state);
+    player.send(frame, message.str());
+  } else {
+    player.send(message.str());
+  }
+  auto sent = chrono::steady_clock::now();
+  auto time_limit = min<chrono::milliseconds>(config::round_timeout, config::global_timeout - player.used_time);
+  return {&player, sent, sent + time_limit};
+}
+
+void Simulation::receive_responses(vector<PendingRequest> pending, map<int, Step>& vampire_steps) {
+  while (!pending.empty()) {
+    auto now = chrono::steady_clock::now();
+    vector<PendingRequest> still_pending;
+    for (const PendingRequest& request : pending) {
+      Player& player = *request.player;
+      if (request.deadline > now) {
+        still_pending.push_back(request);
+        continue;
+      }
+      // Stays in place, the response is dropped when it comes
+      player.used_time += chrono::duration_cast<chrono::milliseconds>(now - request.sent);
+      ++player.late_responses;
+      LOG(WARN) << "Player " << player.vampire_id << ": Round time limit exceeded, total time used: "
+                << player.used_time.count();
+      if (player.used_time >= config::global_timeout) {
+        LOG(WARN) << "Player " << player.vampire_id << ": Global time limit exceeded, no more requests";
+      }
+    }
+    pending = move(still_pending);
+    if (pending.empty()) break;
+
+    auto next_deadline = chrono::steady_clock::time_point::max();
+    vector<pollfd> fds;
+    for (const PendingRequest& request : pending) {
+      next_deadline = min(next_deadline, request.deadline);
+      fds.push_back({request.player->output, POLLIN, 0});
+    }
+    if (SharedTransport* transport = pending[0].player->transport) {
+      // The doorbell is read before the rings are checked, so a response written in between ends the wait
+      uint32_t seen = transport->server_doorbell().rings.load();
+      bool ready = any_of(pending.begin(), pending.end(), [](const PendingRequest& request) {
+        return request.player->ready();
+      });
+      if (!ready) {
+        transport->server_doorbell().wait(seen, min(next_deadline, now + SharedTransport::liveness_interval));
+        // Nothing has come for a while, a bot may be gone without closing
+        if (transport->server_doorbell().rings.load() == seen) {
+          for (const PendingRequest& request : pending) request.player->check_alive();
+        }
+      }
+      for (pollfd& fd : fds) fd.revents = POLLIN;
+    } else {
+      int timeout = chrono::duration_cast<chrono::milliseconds>(next_deadline - now).count() + 1;
+      if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) error("poll failed");
+    }
+
+    now = chrono::steady_clock::now();
+    still_pending.clear();
+    for (size_t i = 0; i < pending.size(); ++i) {
+      Player& player = *pending[i].player;
+      auto round_time = chrono::duration_cast<chrono::milliseconds>(now - pending[i].sent);
+      bool open = !fds[i].revents || player.receive();
+      optional<string> message = player.next_message();
+      for (; message && player.late_responses > 0; message = player.next_message()) --player.late_responses;
+      if (message) {
+        player.used_time += round_time;
+        vampire_steps[player.vampire_id] = parse_response(player, *message);
+      } else if (!open) {
+        // Fails to parse, like reading a closed stream did
+        vampire_steps[player.vampire_id] = parse_response(player, exchange(player.received, ""));
+      } else {
+        still_pending.push_back(pending[i]);
+      }
+    }
+    pending = move(still_pending);
+  }
 }
 
-Step Simulation::receive_response(Player& player) const {
+Step Simulation::parse_response(Player& player, const string& message) {
   try {
-    auto request_sent = chrono::high_resolution_clock::now();
-    protocol::Response response(player.output);
-    //    cerr << response << endl;
-    auto response_received = chrono::high_resolution_clock::now();
-    auto round_time = chrono::duration_cast<chrono::milliseconds>(response_received - request_sent);
-    if (round_time > config::round_timeout) {
-      // player.input << protocol::Wrong{"Round time limit exceeded"};
-      // return {};
-      cerr << "Player " << player.vampire_id << ": Round time limit exceeded, time: " << round_time.count() << endl;
+    int game_id, tick, vampire_id;
+    Step step;
+    if (player.binary_protocol) {
+      string_view data = message;
+      binary::FrameType type;
+      string_view payload;
+      if (!binary::split_frame(data, type, payload)) throw runtime_error("Truncated binary message");
+      if (type == binary::FrameType::RESYNC && player.delta_states) {
+        player.delta_base.reset();
+      } else if (type != binary::FrameType::RESPONSE) {
+        throw runtime_error("Expected a response frame");
+      }
+      binary::Response response = binary::decode_response(payload);
+      tie(game_id, tick, vampire_id, step) = tie(response.game_id, response.tick, response.vampire_id, response.step);
+    } else {
+      protocol::Response response(message);
+      tie(game_id, tick, vampire_id, step) = tie(response.game_id, response.tick, response.vampire_id, response.step);
     }
-    if (response.game_id != init_data.game_id || response.tick != grid.tick ||
-        response.vampire_id != player.vampire_id) {
-      player.input << protocol::Wrong{"Invalid response"};
+    if (game_id != init_data.game_id || tick != grid.tick || vampire_id != player.vampire_id) {
+      send_wrong(player, "Invalid response");
       return {};
     }
-    return response.step;
+    return step;
   } catch (const runtime_error& error) {
-    player.input << protocol::Wrong{error.what()};
+    send_wrong(player, error.what());
     return {};
   }
 }
+
+void Simulation::send_wrong(Player& player, const string& reason) {
+  message.clear();
+  message << "WRONG " << reason << "\n.\n";
+  if (player.binary_protocol) {
+    frame.clear();
+    binary::encode_wrong(frame, reason);
+    player.send(frame, message.str());
+  } else {
+    player.send(message.str());
+  }
+}
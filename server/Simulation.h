@@ -2,11 +2,15 @@
 #define ITECH21_SIMULATION_H
 
 #include <array>
+#include <chrono>
+#include <map>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "../common/GameState.h"
 #include "../common/Grid.h"
+#include "../common/Writer.h"
 #include "Player.h"
 
 class Simulation {
@@ -19,8 +23,23 @@ class Simulation {
   void run();
 
  protected:
-  void send_request(Player& player, const GameState& game_state) const;
-  Step receive_response(Player& player) const;
+  struct PendingRequest {
+    Player* player;
+    std::chrono::steady_clock::time_point sent;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  Writer state_text;  // the state of the tick, formatted once for all the players
+  Writer message;     // reused, so a request needs no allocation
+  std::string frame;  // the same for the players of the binary protocol
+
+  void send_wrong(Player& player, const std::string& reason);
+
+  PendingRequest send_request(Player& player, const GameState& game_state);
+  // Waits for the responses of all the players at once, each until its own deadline. The steps of the players who
+  // don't answer in time are left as they are.
+  void receive_responses(std::vector<PendingRequest> pending, std::map<int, Step>& vampire_steps);
+  Step parse_response(Player& player, const std::string& message);
 };
 
 #endif  // ITECH21_SIMULATION_H
@@ -10,6 +10,7 @@ using namespace std::chrono_literals;
 inline constexpr int target_tower_count = 100;
 inline constexpr auto round_timeout = 2000ms;
 inline constexpr auto global_timeout = 10 * 60 * 1000ms;
+inline constexpr int keyframe_interval = 100;  // requests, with the delta protocol
 
 }  // namespace config
 
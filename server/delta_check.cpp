@@ -0,0 +1,94 @@
+// Plays random steps on a map and sends every state through the DELTA frames of the server, keyframes included, to a
+// decoder that keeps its state like a bot does. Every decoded state is compared with the text of the one sent, the
+// first difference is reported and fails the check.
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/BinaryCodec.h"
+#include "../common/GameState.h"
+#include "../common/Grid.h"
+#include "../common/Log.h"
+#include "../common/Writer.h"
+#include "config.h"
+
+using namespace std;
+
+vector<string> read_message(istream& in) {
+  vector<string> lines;
+  string line;
+  while (getline(in, line) && line != ".") lines.push_back(line);
+  return lines;
+}
+
+// What the server keeps for a player and what the bot keeps for the deltas
+struct Connection {
+  uint32_t sequence = 0;
+  optional<GameState> base;
+  GameState received;
+  uint32_t received_sequence = 0;
+};
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    cerr << "usage: delta_check <map> [games]" << endl;
+    return 1;
+  }
+  const int games = argc > 2 ? stoi(argv[2]) : 10;
+  Log::set_level(LogLevel::NONE);
+  size_t frames = 0, bytes = 0;
+
+  for (int seed = 0; seed < games; ++seed) {
+    ifstream map_file(argv[1]);
+    InitialData init_data(read_message(map_file));
+    GameState map_state(read_message(map_file));
+    Grid grid(seed, true /* server */);
+    grid.init(map_state, init_data);
+    mt19937 random(seed);
+    map<int, Connection> connections;
+
+    for (GameState state = grid.get_state(); !state.vampires.empty(); state = grid.get_state()) {
+      Writer state_text;
+      state_text << state;
+      map<int, Step> steps;
+      for (const Vampire& vampire : state.vampires) {
+        Connection& connection = connections[vampire.id];
+        if (++connection.sequence % config::keyframe_interval == 0) connection.base.reset();
+        string frame;
+        binary::encode_delta(frame, init_data.game_id, grid.tick, vampire.id, connection.sequence,
+                             connection.base ? &*connection.base : nullptr, state);
+        connection.base = state;
+        ++frames;
+        bytes += frame.size();
+
+        string_view data = frame;
+        binary::FrameType type;
+        string_view payload;
+        Writer received_text;
+        if (binary::split_frame(data, type, payload) && type == binary::FrameType::DELTA &&
+            binary::apply_delta(payload, connection.received, connection.received_sequence)) {
+          received_text << connection.received;
+        }
+        if (received_text.str() != state_text.str() || connection.received.tick != grid.tick ||
+            connection.received.vampire_id != vampire.id) {
+          cerr << argv[1] << ": game " << seed << ", tick " << grid.tick << ": DELTA frame " << connection.sequence
+               << " of vampire " << vampire.id << " decodes to another state" << endl;
+          return 1;
+        }
+
+        Step& step = steps[vampire.id];
+        step.move = moves_3[random() % moves_3.size()];
+        step.place_grenade = random() % 32 == 0;
+      }
+      grid.step(steps);
+    }
+  }
+  cout << frames << " DELTA frames decoded to the states sent, " << bytes / max<size_t>(frames, 1)
+       << " bytes on average" << endl;
+}
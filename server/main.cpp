@@ -1,7 +1,16 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <vector>
 
+#include <unistd.h>
+
+#include "../common/Log.h"
+#include "../common/SharedTransport.h"
+#include "config.h"
 #include "Player.h"
 #include "Simulation.h"
 #include "protocol.h"
@@ -9,46 +18,90 @@
 using namespace std;
 
 int main(int argc, char** argv) {
+  // A bot that exits fails to answer instead of stopping the match
+  signal(SIGPIPE, SIG_IGN);
+  // The seed of the random generator, for playing the same map with different powerups
+  int seed = 0;
+  // The bots on this host may talk through shared memory instead of FIFOs, they have to be started with --shm too
+  bool shm = false;
+  while (argc > 1) {
+    if (argc > 2 && string(argv[1]) == "--seed") {
+      seed = stoi(argv[2]);
+      argc -= 2;
+      argv += 2;
+    } else if (string(argv[1]) == "--shm") {
+      shm = true;
+      --argc;
+      ++argv;
+    } else {
+      break;
+    }
+  }
   if (argc < 3) {
-    cerr << "usage: server <map> <bot1> ... <botN>" << endl;
+    cerr << "usage: server [--seed <seed>] [--shm] <map> <bot1> ... <botN>" << endl;
     return 1;
   }
   const int player_count = argc - 2;
+  unique_ptr<SharedTransport> transport;  // outlives the players
   vector<Player> players;
   players.reserve(player_count);
-  ostringstream mkfifo_command("mkfifo", ios_base::ate);
-  for (int i = 1; i <= player_count; ++i)
-    mkfifo_command << " player" << i << ".in"
-                   << " player" << i << ".out";
-  cout << mkfifo_command.str() << endl;
-  if (system(mkfifo_command.str().c_str())) {
-    cerr << "failed to create fifos" << endl;
-    return 1;
+  if (shm) {
+    const string name = "/itech21_server_" + to_string(getpid());
+    try {
+      transport = SharedTransport::create(name, player_count);
+    } catch (const runtime_error& error) {
+      LOG(ERR) << error.what();
+      return 1;
+    }
+    setenv(SharedTransport::name_variable, name.c_str(), 1);
+  } else {
+    ostringstream mkfifo_command("mkfifo", ios_base::ate);
+    for (int i = 1; i <= player_count; ++i)
+      mkfifo_command << " player" << i << ".in"
+                     << " player" << i << ".out";
+    cout << mkfifo_command.str() << endl;
+    if (system(mkfifo_command.str().c_str())) {
+      LOG(ERR) << "failed to create fifos";
+      return 1;
+    }
   }
   for (int i = 1; i <= player_count; ++i) {
     ostringstream start_bot_command(argv[i + 1], std::ios_base::ate);
-    start_bot_command << " <player" << i << ".in"
-                      << " >player" << i << ".out"
-                      << " 2>player" << i << ".log"
+    if (shm) {
+      // The bot inherits the environment naming its channel
+      setenv(SharedTransport::player_variable, to_string(i).c_str(), 1);
+      start_bot_command << " </dev/null >/dev/null";
+    } else {
+      start_bot_command << " <player" << i << ".in"
+                        << " >player" << i << ".out";
+    }
+    start_bot_command << " 2>player" << i << ".log"
                       << " &";
     cout << start_bot_command.str() << endl;
     if (system(start_bot_command.str().c_str())) {
-      cerr << "failed to start bot #" << i << ":" << endl << start_bot_command.str() << endl;
+      LOG(ERR) << "failed to start bot #" << i << ":\n" << start_bot_command.str();
       return 1;
     }
-    players.emplace_back(i);
+    players.emplace_back(i, transport.get());
   }
 
   for (Player& player : players) {
     try {
-      protocol::Login login(player.output);
+      protocol::Login login(player.read_message(chrono::steady_clock::now() + config::round_timeout).value_or(""));
+      player.binary_protocol = login.binary_protocol;
+      player.delta_states = login.delta_states;
     } catch (const runtime_error& error) {
-      player.input << protocol::Wrong{error.what()};
+      ostringstream wrong;
+      wrong << protocol::Wrong{error.what()};
+      player.send(wrong.str());
       return 0;
     }
-    cerr << player.name << " logged in" << endl;
+    const char* protocol = player.delta_states      ? " with delta states"
+                           : player.binary_protocol ? " with the binary protocol"
+                                                    : "";
+    LOG(INFO) << player.name << " logged in" << protocol;
   }
 
-  Simulation simulation{move(players), 0, argv[1]};
+  Simulation simulation{move(players), seed, argv[1]};
   simulation.run();
 }
\ No newline at end of file
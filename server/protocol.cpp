@@ -1,57 +1,68 @@
 #include "protocol.h"
 
 #include <algorithm>
-#include <sstream>
+#include <stdexcept>
+
+#include "../common/BinaryCodec.h"
+#include "../common/Scanner.h"
 
 using namespace std;
 
 namespace protocol {
-string read_message(istream& in) {
-  string message, line;
-  getline(in, line);
-  while (in && line != ".") {
-    message += line + '\n';
-    getline(in, line);
-  }
-  if (in.fail()) {
-    throw runtime_error("Failed to read command: " + message + ", last line: " + line);
+// The lines before the "." line, each ending with '\n'
+string_view read_message(string_view text) {
+  string_view rest = text, line;
+  while (Scanner::getline(rest, line)) {
+    if (line == ".") return text.substr(0, line.data() - text.data());
   }
-  return message;
+  // Like std::getline, a last line without '\n' is read twice, and an empty one after a '\n'
+  const bool ends_line = text.empty() || text.back() == '\n';
+  const string message = string(text) + (ends_line ? "" : "\n");
+  throw runtime_error("Failed to read command: " + message + ", last line: " + (ends_line ? "" : string(line)));
 }
 
-Login::Login(istream& in) {
-  const string message = read_message(in);
-  stringstream parser(message);
-  string message_keyword;
+Login::Login(string_view text) {
+  const string_view message = read_message(text);
+  Scanner parser(message);
+  string_view message_keyword;
   parser >> message_keyword >> token;
   if (parser.fail() || message_keyword != keyword) {
-    throw runtime_error("Failed to parse command " + keyword + " from message " + message);
+    throw runtime_error("Failed to parse command " + keyword + " from message " + string(message));
+  }
+  // The level and the options follow the token
+  for (string_view option = parser.word(); !option.empty(); option = parser.word()) {
+    if (option == binary::login_token) binary_protocol = true;
+    if (option == binary::delta_login_token) binary_protocol = delta_states = true;
   }
 }
 
-ostream& operator<<(ostream& out, const EndMessage& end) { return out << end.dot << endl; }
+Writer& operator<<(Writer& out, const EndMessage& end) { return out << end.dot << '\n'; }
+ostream& operator<<(ostream& out, const EndMessage& end) { return out << end.dot << '\n'; }
 
+Writer& operator<<(Writer& out, const Request& request) {
+  return out << request.keyword << ' ' << request.game_id << ' ' << request.tick << ' ' << request.vampire_id << '\n';
+}
 ostream& operator<<(ostream& out, const Request& request) {
-  return out << request.keyword << ' ' << request.game_id << ' ' << request.tick << ' ' << request.vampire_id << endl;
+  return out << request.keyword << ' ' << request.game_id << ' ' << request.tick << ' ' << request.vampire_id << '\n';
 }
 
-Direction dir_from_char(char dir, string message) {
+Direction dir_from_char(char dir, string_view message) {
   const string directions = "URDL";
   if (directions.find(dir) == string::npos) {
-    throw runtime_error("Failed to interpret direction " + string(1, dir) + " from message " + message);
+    throw runtime_error("Failed to interpret direction " + string(1, dir) + " from message " + string(message));
   }
   return static_cast<Direction>(directions.find(dir));
 }
 
-Response::Response(istream& in) {
-  const string message = read_message(in);
-  stringstream parser(message);
-  string message_keyword;
+Response::Response(string_view text) {
+  const string_view message = read_message(text);
+  Scanner parser(message);
+  string_view message_keyword;
   parser >> message_keyword >> game_id >> tick >> vampire_id;
   if (parser.fail() || message_keyword != keyword) {
-    throw runtime_error("Failed to parse command " + keyword + " from message " + message);
+    throw runtime_error("Failed to parse command " + keyword + " from message " + string(message));
   }
-  string step_keyword;
+  string_view step_keyword;
   parser >> step_keyword;
   if (step_keyword == "GRENADE") {
     step.place_grenade = true;
@@ -67,14 +78,14 @@ Response::Response(istream& in) {
     thro.dir = dir_from_char(dir, message);
     parser >> thro.length;
     if (parser.fail()) {
-      throw runtime_error("Failed to parse command THROW from message " + message);
+      throw runtime_error("Failed to parse command THROW from message " + string(message));
     }
     step.throw_grenades = thro;
     parser >> step_keyword;
   }
   step.move = vector<Direction>();
   if (!parser.fail() && step_keyword != "MOVE") {
-    throw runtime_error("Failed to parse command MOVE from message " + message);
+    throw runtime_error("Failed to parse command MOVE from message " + string(message));
   }
   char dir;
   while (parser >> dir) {
@@ -85,15 +96,15 @@ Response::Response(istream& in) {
 std::ostream& operator<<(std::ostream& out, const Response& response) {
   return out << response.keyword << ' ' << response.game_id << ' ' << response.tick << ' ' << response.vampire_id
              << '\n'
-             << response.step.to_string() << endl;
+             << response.step.to_string() << '\n';
 }
 
 ostream& operator<<(ostream& out, const Wrong& wrong) {
-  return out << wrong.keyword << ' ' << wrong.reason << "\n." << endl;
+  return out << wrong.keyword << ' ' << wrong.reason << "\n.\n";
 }
 
 ostream& operator<<(ostream& out, const Success& success) {
-  return out << success.keyword << ' ' << success.score << "\n." << endl;
+  return out << success.keyword << ' ' << success.score << "\n.\n";
 }
 
 }  // namespace protocol
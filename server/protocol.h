@@ -5,8 +5,10 @@
 #include <istream>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 #include "../common/GameState.h"
+#include "../common/Writer.h"
 #include "config.h"
 
 namespace protocol {
@@ -15,7 +17,10 @@ class Login {
  public:
   const std::string keyword = "LOGIN";
   std::string token;
-  explicit Login(std::istream& in);
+  bool binary_protocol = false;  // the bot asked for the binary protocol, see BinaryCodec.h
+  bool delta_states = false;     // and for the delta encoded requests, which need it
+  // Parses a whole message, with its "." line, in place
+  explicit Login(std::string_view text);
 };
 
 class Request {
@@ -25,11 +30,13 @@ class Request {
   int vampire_id;
   const std::string keyword = "REQ";
 };
+Writer& operator<<(Writer& out, const Request& request);
 std::ostream& operator<<(std::ostream& out, const Request& request);
 
 struct EndMessage {
   const char dot = '.';
 };
+Writer& operator<<(Writer& out, const EndMessage& end);
 std::ostream& operator<<(std::ostream& out, const EndMessage& end);
 
 class Response {
@@ -39,7 +46,8 @@ class Response {
   int vampire_id;
   const std::string keyword = "RES";
   Step step;
-  explicit Response(std::istream& in);
+  // Parses a whole message, with its "." line, in place
+  explicit Response(std::string_view text);
 };
 std::ostream& operator<<(std::ostream& out, const Response& response);
 
@@ -0,0 +1,174 @@
+// Plays every bot against the others on the maps of ai-arena.game.config.json, over a range of seeds and in every
+// seating order of the bots. The games run in parallel, each with its own server process in its own directory under
+// games/, so bot commands are run from there, with links to the tables of the working directory. A JSON line is
+// appended to the results file as each game finishes, and the mean, the standard deviation and the 95% confidence
+// interval of the scores of each bot at the end.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// The files the bots load from their working directory, see AI::load_tables
+const vector<string> bot_tables = {"endgame.tbl", "opening.book", "opponent.model", "evaluator.weights"};
+
+struct Game {
+  string map_name;
+  fs::path map_path;
+  int seed;
+  vector<int> seating;  // the index of the bot playing vampire 1, 2, ...
+};
+
+struct GameResult {
+  bool ok = false;
+  vector<double> scores;  // by seat
+};
+
+// The "name" and "path" of the entries of the "maps" array, enough of JSON for the config
+vector<pair<string, fs::path>> read_maps(const fs::path& config_file) {
+  ifstream f(config_file);
+  stringstream buffer;
+  buffer << f.rdbuf();
+  string config = buffer.str();
+  auto string_after = [&config](const string& key, size_t from, size_t to) -> pair<string, size_t> {
+    size_t pos = config.find("\"" + key + "\"", from);
+    if (pos >= to) return {"", string::npos};
+    size_t begin = config.find('"', config.find(':', pos) + 1) + 1;
+    size_t end = config.find('"', begin);
+    return {config.substr(begin, end - begin), end};
+  };
+
+  vector<pair<string, fs::path>> maps;
+  size_t begin = config.find("\"maps\"");
+  if (begin == string::npos) return maps;
+  size_t end = config.find(']', begin);
+  for (size_t pos = begin; pos < end;) {
+    auto [name, name_end] = string_after("name", pos, end);
+    auto [path, path_end] = string_after("path", pos, end);
+    if (name_end == string::npos || path_end == string::npos) break;
+    maps.emplace_back(name, fs::absolute(config_file.parent_path() / path));
+    pos = max(name_end, path_end);
+  }
+  return maps;
+}
+
+GameResult play(const Game& game, const fs::path& server, bool shm, const vector<string>& bots, const fs::path& dir) {
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  for (const string& table : bot_tables) {
+    if (fs::exists(table)) fs::create_symlink(fs::absolute(table), dir / table);
+  }
+  ostringstream command;
+  command << "cd '" << dir.string() << "' && '" << server.string() << "' --seed " << game.seed
+          << (shm ? " --shm '" : " '") << game.map_path.string() << "'";
+  for (int bot : game.seating) command << " '" << bots[bot] << "'";
+  command << " >server.out 2>server.log";
+
+  GameResult result;
+  if (system(command.str().c_str())) return result;
+  ifstream scores(dir / "scores.json");
+  char c;
+  double score;
+  scores >> c;  // [
+  while (scores >> score) {
+    result.scores.push_back(score);
+    scores >> c;  // , or ]
+  }
+  result.ok = result.scores.size() == game.seating.size();
+  return result;
+}
+
+int main(int argc, char** argv) {
+  const fs::path server = fs::absolute(fs::path(argv[0]).parent_path() / "server");
+  // The servers talk to the bots through shared memory, the bot commands need --shm then too
+  const bool shm = argc > 1 && string(argv[1]) == "--shm";
+  if (shm) {
+    --argc;
+    ++argv;
+  }
+  if (argc < 5) {
+    cerr << "usage: tournament [--shm] <results> <first seed> <seeds> <bot1> ... <botN>\n"
+            "The maps are read from ai-arena.game.config.json, or from the file in the TOURNAMENT_CONFIG environment\n"
+            "variable, the number of parallel games is the number of cores, or TOURNAMENT_JOBS"
+         << endl;
+    return 1;
+  }
+  const int first_seed = stoi(argv[2]);
+  const int seeds = stoi(argv[3]);
+  const vector<string> bots(argv + 4, argv + argc);
+  const char* config = getenv("TOURNAMENT_CONFIG");
+  const char* jobs_env = getenv("TOURNAMENT_JOBS");
+  const int jobs = jobs_env ? stoi(jobs_env) : max(1u, thread::hardware_concurrency());
+
+  vector<pair<string, fs::path>> maps = read_maps(config ? config : "ai-arena.game.config.json");
+  if (maps.empty()) {
+    cerr << "No maps found in the config" << endl;
+    return 1;
+  }
+  vector<Game> games;
+  for (const auto& [map_name, map_path] : maps) {
+    for (int seed = first_seed; seed < first_seed + seeds; ++seed) {
+      vector<int> seating(bots.size());
+      for (size_t i = 0; i < seating.size(); ++i) seating[i] = i;
+      do {
+        games.push_back({map_name, map_path, seed, seating});
+      } while (next_permutation(seating.begin(), seating.end()));
+    }
+  }
+  cerr << games.size() << " games on " << jobs << " threads" << endl;
+
+  ofstream results(argv[1]);
+  mutex results_mutex;
+  vector<vector<double>> bot_scores(bots.size());
+  atomic<size_t> next_game{0};
+  size_t finished = 0, failed = 0;
+  auto worker = [&]() {
+    for (size_t i = next_game++; i < games.size(); i = next_game++) {
+      const Game& game = games[i];
+      fs::path dir = fs::absolute("games") / (game.map_name + "_" + to_string(game.seed) + "_" + to_string(i));
+      GameResult result = play(game, server, shm, bots, dir);
+
+      lock_guard<mutex> lock(results_mutex);
+      results << "{\"map\": \"" << game.map_name << "\", \"seed\": " << game.seed << ", \"bots\": [";
+      for (size_t seat = 0; seat < game.seating.size(); ++seat) results << (seat ? ", " : "") << game.seating[seat];
+      results << "], \"scores\": [";
+      for (size_t seat = 0; seat < result.scores.size(); ++seat) results << (seat ? ", " : "") << result.scores[seat];
+      results << "], \"ok\": " << (result.ok ? "true" : "false") << ", \"dir\": \"" << dir.string() << "\"}" << endl;
+      if (result.ok) {
+        for (size_t seat = 0; seat < game.seating.size(); ++seat) {
+          bot_scores[game.seating[seat]].push_back(result.scores[seat]);
+        }
+      } else {
+        ++failed;
+      }
+      cerr << "\r" << ++finished << "/" << games.size() << " games, " << failed << " failed" << flush;
+    }
+  };
+  vector<thread> threads;
+  for (int i = 0; i < jobs; ++i) threads.emplace_back(worker);
+  for (thread& thread : threads) thread.join();
+  cerr << endl;
+
+  for (size_t bot = 0; bot < bots.size(); ++bot) {
+    const vector<double>& scores = bot_scores[bot];
+    double n = scores.size(), mean = 0, variance = 0;
+    for (double score : scores) mean += score / max(n, 1.0);
+    for (double score : scores) variance += (score - mean) * (score - mean) / max(n - 1, 1.0);
+    double stddev = sqrt(variance), ci95 = 1.96 * stddev / sqrt(max(n, 1.0));
+    results << "{\"bot\": \"" << bots[bot] << "\", \"games\": " << scores.size() << ", \"mean\": " << mean
+            << ", \"stddev\": " << stddev << ", \"ci95\": [" << mean - ci95 << ", " << mean + ci95 << "]}" << endl;
+    cerr << bots[bot] << ": " << mean << " +- " << ci95 << " (stddev " << stddev << ", " << scores.size() << " games)"
+         << endl;
+  }
+}